@@ -1,12 +1,56 @@
 #include <SDL2/SDL.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
 
 #include "game.hpp"
 #include "graphics.hpp"
 #include "input_manager.hpp"
+#ifdef PERIA_BENCHMARKS
+    #include "benchmark.hpp"
+#endif
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+namespace {
+
+// whole arg must be number in [Game::MIN_TICK_RATE, Game::MAX_TICK_RATE]
+[[nodiscard]]
+std::optional<float> parse_tick_rate(std::string_view arg)
+{
+    float hz{};
+    const auto end = arg.data() + arg.size();
+    const auto [ptr, ec] = std::from_chars(arg.data(), end, hz);
+    if (ec != std::errc{} || ptr != end) return std::nullopt;
+    if (!(hz >= Game::MIN_TICK_RATE && hz <= Game::MAX_TICK_RATE)) return std::nullopt;
+    return hz;
+}
+
+}
+
+int main(int argc, char** argv)
 {
+#ifdef PERIA_BENCHMARKS
+    // headless collision benchmarks, no window is created
+    if (argc > 1 && std::string_view{argv[1]} == "--bench") {
+        peria::run_benchmarks(argc > 2 ? argv[2] : "");
+        return 0;
+    }
+#endif
+
+    // --tick-rate <hz> runs simulation at different fixed rate, default is 60
+    std::optional<float> tick_rate;
+    if (argc > 1 && std::string_view{argv[1]} == "--tick-rate") {
+        tick_rate = parse_tick_rate(argc > 2 ? argv[2] : "");
+        if (!tick_rate) {
+            std::cerr << "usage: asteroids [--tick-rate <hz>], hz between "
+                      << Game::MIN_TICK_RATE << " and " << Game::MAX_TICK_RATE << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
     Graphics graphics{Window_Settings{"asteroids", 1600, 900, false, true}};
     graphics.set_clear_color(1.0f, 1.0f, 1.0f, 1.0f);
     graphics.vsync(false);
@@ -14,6 +58,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
     Input_Manager im{};
 
     Game asteroids{graphics, im};
+    if (tick_rate) asteroids.set_tick_rate(*tick_rate);
     asteroids.run();
 
     return 0;
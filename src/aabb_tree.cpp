@@ -0,0 +1,304 @@
+#include "aabb_tree.hpp"
+
+#include <algorithm>
+
+namespace peria {
+
+Aabb_Tree::Aabb_Tree(float fat_margin)
+    :_fat_margin{fat_margin}
+{}
+
+Aabb_Tree::Cone_Sides Aabb_Tree::cone_sides(const Cone& cone)
+{
+    // sides are dir rotated by +-half angle, normals turn further away from dir
+    const auto c = cone.cos_half_angle;
+    const auto sn = std::sqrt(std::max(0.0f, 1.0f - c*c));
+    const auto d = cone.dir;
+    const glm::vec2 left{c*d.x - sn*d.y, sn*d.x + c*d.y};
+    const glm::vec2 right{c*d.x + sn*d.y, -sn*d.x + c*d.y};
+    return {{-left.y, left.x}, {right.y, -right.x}};
+}
+
+std::array<glm::vec2, 9> Aabb_Tree::wrapped_points(glm::vec2 point, glm::vec2 world_size)
+{
+    std::array<glm::vec2, 9> res;
+    res[0] = point;
+    std::size_t i=1;
+    for (const auto x:{-1.0f, 0.0f, 1.0f}) {
+        for (const auto y:{-1.0f, 0.0f, 1.0f}) {
+            if (x != 0.0f || y != 0.0f) res[i++] = point + glm::vec2{x, y}*world_size;
+        }
+    }
+    return res;
+}
+
+uint32_t Aabb_Tree::allocate_node()
+{
+    if (_free_list == NONE) {
+        _nodes.emplace_back();
+        _nodes.back().height = -1;
+        _free_list = static_cast<uint32_t>(_nodes.size()-1);
+        _nodes.back().parent = NONE;
+    }
+
+    const auto node = _free_list;
+    _free_list = _nodes[node].parent;
+
+    auto& n = _nodes[node];
+    n.parent = NONE;
+    n.child1 = NONE;
+    n.child2 = NONE;
+    n.height = 0;
+    n.user = 0;
+    return node;
+}
+
+void Aabb_Tree::free_node(uint32_t node)
+{
+    _nodes[node].parent = _free_list;
+    _nodes[node].height = -1;
+    _free_list = node;
+}
+
+Aabb_Tree::Proxy Aabb_Tree::insert(const AABB_Collider& bounds, uint32_t user)
+{
+    const auto leaf = allocate_node();
+    const auto margin = glm::vec2{_fat_margin};
+    auto box = to_box(bounds);
+    _nodes[leaf].box = {box.min - margin, box.max + margin};
+    _nodes[leaf].user = user;
+
+    insert_leaf(leaf);
+    ++_leaf_count;
+    return leaf;
+}
+
+void Aabb_Tree::remove(Proxy proxy)
+{
+    PERIA_ASSERT(proxy < _nodes.size() && _nodes[proxy].height == 0, "removing invalid proxy");
+
+    remove_leaf(proxy);
+    free_node(proxy);
+    --_leaf_count;
+}
+
+bool Aabb_Tree::move(Proxy proxy, const AABB_Collider& bounds)
+{
+    PERIA_ASSERT(proxy < _nodes.size() && _nodes[proxy].height == 0, "moving invalid proxy");
+
+    const auto box = to_box(bounds);
+    if (contains(_nodes[proxy].box, box)) return false;
+
+    remove_leaf(proxy);
+    const auto margin = glm::vec2{_fat_margin};
+    _nodes[proxy].box = {box.min - margin, box.max + margin};
+    insert_leaf(proxy);
+    return true;
+}
+
+void Aabb_Tree::clear()
+{
+    _nodes.clear();
+    _root = NONE;
+    _free_list = NONE;
+    _leaf_count = 0;
+}
+
+void Aabb_Tree::insert_leaf(uint32_t leaf)
+{
+    if (_root == NONE) {
+        _root = leaf;
+        _nodes[leaf].parent = NONE;
+        return;
+    }
+
+    // walk down to sibling with lowest cost, cost is perimeter of boxes that grow
+    const auto leaf_box = _nodes[leaf].box;
+    auto index = _root;
+    while (!_nodes[index].is_leaf()) {
+        const auto& node = _nodes[index];
+        const auto area = perimeter(node.box);
+        const auto combined_area = perimeter(merge(node.box, leaf_box));
+
+        // cost of new parent for this node and leaf
+        const auto cost = 2.0f * combined_area;
+        // cost of pushing leaf further down, every ancestor grows
+        const auto inheritance_cost = 2.0f * (combined_area - area);
+
+        auto child_cost = [&](uint32_t child) {
+            const auto& c = _nodes[child];
+            const auto merged = perimeter(merge(c.box, leaf_box));
+            return (c.is_leaf() ? merged : merged - perimeter(c.box)) + inheritance_cost;
+        };
+        const auto cost1 = child_cost(node.child1);
+        const auto cost2 = child_cost(node.child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const auto sibling = index;
+    const auto old_parent = _nodes[sibling].parent;
+    const auto new_parent = allocate_node(); // may reallocate _nodes, no references above this point
+
+    auto& p = _nodes[new_parent];
+    p.parent = old_parent;
+    p.box = merge(leaf_box, _nodes[sibling].box);
+    p.height = _nodes[sibling].height + 1;
+    p.child1 = sibling;
+    p.child2 = leaf;
+
+    if (old_parent != NONE) {
+        auto& op = _nodes[old_parent];
+        if (op.child1 == sibling) op.child1 = new_parent;
+        else                      op.child2 = new_parent;
+    }
+    else {
+        _root = new_parent;
+    }
+    _nodes[sibling].parent = new_parent;
+    _nodes[leaf].parent = new_parent;
+
+    refit(_nodes[leaf].parent);
+}
+
+void Aabb_Tree::remove_leaf(uint32_t leaf)
+{
+    if (leaf == _root) {
+        _root = NONE;
+        return;
+    }
+
+    const auto parent = _nodes[leaf].parent;
+    const auto grand_parent = _nodes[parent].parent;
+    const auto sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    // sibling takes place of parent
+    if (grand_parent != NONE) {
+        auto& gp = _nodes[grand_parent];
+        if (gp.child1 == parent) gp.child1 = sibling;
+        else                     gp.child2 = sibling;
+        _nodes[sibling].parent = grand_parent;
+        free_node(parent);
+        refit(grand_parent);
+    }
+    else {
+        _root = sibling;
+        _nodes[sibling].parent = NONE;
+        free_node(parent);
+    }
+}
+
+void Aabb_Tree::refit(uint32_t node)
+{
+    while (node != NONE) {
+        node = balance(node);
+
+        auto& n = _nodes[node];
+        const auto& c1 = _nodes[n.child1];
+        const auto& c2 = _nodes[n.child2];
+        n.height = 1 + std::max(c1.height, c2.height);
+        n.box = merge(c1.box, c2.box);
+
+        node = n.parent;
+    }
+}
+
+// Rotates taller grandchild up if subtree of 'a' is imbalanced.
+// Returns index of node that is now at place of 'a'.
+uint32_t Aabb_Tree::balance(uint32_t a)
+{
+    auto& node_a = _nodes[a];
+    if (node_a.is_leaf() || node_a.height < 2) return a;
+
+    const auto b = node_a.child1;
+    const auto c = node_a.child2;
+    const auto diff = _nodes[c].height - _nodes[b].height;
+    if (diff >= -1 && diff <= 1) return a;
+
+    // 'up' is taller child and gets rotated to place of a, 'other' stays under a
+    const auto up = diff > 1 ? c : b;
+    const auto other = diff > 1 ? b : c;
+    auto& node_up = _nodes[up];
+
+    const auto f = node_up.child1;
+    const auto g = node_up.child2;
+
+    // swap a and up
+    node_up.child1 = a;
+    node_up.parent = node_a.parent;
+    node_a.parent = up;
+
+    if (node_up.parent != NONE) {
+        auto& p = _nodes[node_up.parent];
+        if (p.child1 == a) p.child1 = up;
+        else               p.child2 = up;
+    }
+    else {
+        _root = up;
+    }
+
+    // taller grandchild stays with up, shorter one moves under a in place of up
+    const auto keep = _nodes[f].height > _nodes[g].height ? f : g;
+    const auto give = keep == f ? g : f;
+
+    node_up.child2 = keep;
+    if (diff > 1) node_a.child2 = give;
+    else          node_a.child1 = give;
+    _nodes[give].parent = a;
+
+    node_a.box = merge(_nodes[other].box, _nodes[give].box);
+    node_a.height = 1 + std::max(_nodes[other].height, _nodes[give].height);
+    node_up.box = merge(node_a.box, _nodes[keep].box);
+    node_up.height = 1 + std::max(node_a.height, _nodes[keep].height);
+
+    return up;
+}
+
+void Aabb_Tree::query(const AABB_Collider& bounds, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    if (_root == NONE) return;
+
+    const auto box = to_box(bounds);
+
+    Stack stack;
+    std::size_t top{};
+    stack[top++] = _root;
+    while (top > 0) {
+        const auto& node = _nodes[stack[--top]];
+        if (!overlaps(node.box, box)) continue;
+
+        if (node.is_leaf()) {
+            out.push_back(node.user);
+            continue;
+        }
+
+        PERIA_ASSERT(top+2 <= STACK_SIZE, "Aabb_Tree stack overflow");
+        stack[top++] = node.child1;
+        stack[top++] = node.child2;
+    }
+}
+
+bool Aabb_Tree::segment_hits(const Box& b, glm::vec2 from, glm::vec2 dir, float max_fraction)
+{
+    auto t_min = 0.0f;
+    auto t_max = max_fraction;
+    for (int i{}; i<2; ++i) {
+        if (std::abs(dir[i]) < 1e-9f) {
+            // parallel with slab, must start inside it
+            if (from[i] < b.min[i] || from[i] > b.max[i]) return false;
+            continue;
+        }
+        const auto inv = 1.0f / dir[i];
+        auto t1 = (b.min[i] - from[i]) * inv;
+        auto t2 = (b.max[i] - from[i]) * inv;
+        if (t1 > t2) std::swap(t1, t2);
+        t_min = std::max(t_min, t1);
+        t_max = std::min(t_max, t2);
+        if (t_min > t_max) return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "physics.hpp"
+
+namespace peria {
+
+// Dynamic bounding volume tree for long lived entities (asteroids, collectibles, ship).
+// Leaves store "fat" aabb, entity bounds enlarged by margin, so entity can move a bit
+// before its leaf has to be reinserted. Tree is kept balanced with rotations.
+// Nodes live in contiguous pool and link to each other by index, freed nodes are reused.
+// Each leaf carries user value (e.g. index into entity vector) reported by queries,
+// it can be changed with 'set_user' when entity vector shifts.
+// Queries test fat bounds, so they may return false positives, never false negatives.
+class Aabb_Tree {
+public:
+    using Proxy = uint32_t;
+    static constexpr Proxy NONE = std::numeric_limits<Proxy>::max();
+
+    struct Ray_Hit {
+        uint32_t user;
+        float fraction; // hit point is from + (to-from)*fraction
+    };
+
+    struct Nearest_Hit {
+        uint32_t user;
+        float distance;
+    };
+
+    // view cone for nearest queries, apex at query point, half angle below 90 degrees
+    struct Cone {
+        glm::vec2 dir; // unit
+        float cos_half_angle;
+    };
+
+    explicit Aabb_Tree(float fat_margin = 10.0f);
+
+    [[nodiscard]]
+    Proxy insert(const AABB_Collider& bounds, uint32_t user);
+
+    void remove(Proxy proxy);
+
+    // returns true if bounds left fat bounds and leaf was reinserted,
+    // false if tree did not change
+    bool move(Proxy proxy, const AABB_Collider& bounds);
+
+    void set_user(Proxy proxy, uint32_t user)
+    { _nodes[proxy].user = user; }
+
+    [[nodiscard]]
+    uint32_t get_user(Proxy proxy) const
+    { return _nodes[proxy].user; }
+
+    // removes all proxies but keeps node pool
+    void clear();
+
+    // writes user values of all leaves whose fat bounds overlap bounds into out
+    void query(const AABB_Collider& bounds, std::vector<uint32_t>& out) const;
+
+    // Closest hit along segment from -> to.
+    // hit_test(user, from, to) returns fraction of exact hit on that segment or nullopt,
+    // segment is clipped by closest hit found so far so farther leaves are skipped.
+    template <typename Hit_Test>
+    [[nodiscard]]
+    std::optional<Ray_Hit> ray_cast(glm::vec2 from, glm::vec2 to, Hit_Test&& hit_test) const;
+
+    // Closest entity to point, within max_distance.
+    // distance_to(user) returns exact distance of entity, it must not be smaller
+    // than distance of point to entity bounds (e.g. distance to closest point or center).
+    // Infinity skips entity, so filters (entity kind, view cone) go into distance_to.
+    template <typename Distance>
+    [[nodiscard]]
+    std::optional<Nearest_Hit> nearest(glm::vec2 point, Distance&& distance_to,
+                                       float max_distance = std::numeric_limits<float>::max()) const;
+
+    // 'nearest' that also skips subtrees whose bounds lie outside cone.
+    // Bounds are tested conservatively, distance_to still has to skip entities outside cone.
+    template <typename Distance>
+    [[nodiscard]]
+    std::optional<Nearest_Hit> nearest_in_cone(glm::vec2 point, const Cone& cone, Distance&& distance_to,
+                                               float max_distance = std::numeric_limits<float>::max()) const;
+
+    // Up to k closest entities to point within max_distance, closest first, written to out.
+    // Same distance_to as 'nearest', leaves farther than k-th best so far are skipped.
+    template <typename Distance>
+    void k_nearest(glm::vec2 point, std::size_t k, Distance&& distance_to, std::vector<Nearest_Hit>& out,
+                   float max_distance = std::numeric_limits<float>::max()) const;
+
+    // 'nearest' on world that wraps around at world_size (entities live in [0, world_size)).
+    // Point is also queried shifted by world size in every direction, so entity across
+    // the edge counts with its wrapped distance. distance_to(user, point) gets the shifted point.
+    // Shifted queries start with best distance so far, most of them stop at root.
+    template <typename Distance>
+    [[nodiscard]]
+    std::optional<Nearest_Hit> nearest_wrapped(glm::vec2 point, glm::vec2 world_size, Distance&& distance_to,
+                                               float max_distance = std::numeric_limits<float>::max()) const;
+
+    template <typename Distance>
+    [[nodiscard]]
+    std::optional<Nearest_Hit> nearest_in_cone_wrapped(glm::vec2 point, const Cone& cone, glm::vec2 world_size, Distance&& distance_to,
+                                                       float max_distance = std::numeric_limits<float>::max()) const;
+
+    // 'k_nearest' on wrapping world, see 'nearest_wrapped'. Each entity is reported once.
+    template <typename Distance>
+    void k_nearest_wrapped(glm::vec2 point, glm::vec2 world_size, std::size_t k, Distance&& distance_to,
+                           std::vector<Nearest_Hit>& out, float max_distance = std::numeric_limits<float>::max()) const;
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _leaf_count; }
+
+    // 0 for empty tree, 1 for single leaf
+    [[nodiscard]]
+    int height() const
+    { return _root == NONE ? 0 : _nodes[_root].height + 1; }
+
+private:
+    struct Box {
+        glm::vec2 min;
+        glm::vec2 max;
+    };
+
+    struct Node {
+        Box box;
+        uint32_t parent; // next free node while node is in free list
+        uint32_t child1;
+        uint32_t child2;
+        int32_t height; // 0 for leaf, -1 for free node
+        uint32_t user;
+
+        [[nodiscard]]
+        bool is_leaf() const
+        { return child1 == NONE; }
+    };
+
+    // Traversal pops node and pushes both its children, so stack holds at most root height + 1
+    // entries (one pending sibling per level). balance() keeps children heights within 1 of each other,
+    // so tree of height h has at least min_nodes(h) nodes (AVL bound, height ~1.44*log2(n)).
+    // Tree high enough to overflow stack would need more nodes than uint32 indices address,
+    // checked at compile time, so release builds don't need to check pushes.
+    static constexpr std::size_t STACK_SIZE = 64;
+    using Stack = std::array<uint32_t, STACK_SIZE>;
+    static_assert([] {
+        uint64_t smaller{1}, min_nodes{2}; // heights 0 and 1
+        for (std::size_t h = 2; h <= STACK_SIZE; ++h) {
+            const auto next = min_nodes + smaller + 1;
+            smaller = min_nodes;
+            min_nodes = next;
+        }
+        return min_nodes > std::numeric_limits<uint32_t>::max();
+    }(), "Aabb_Tree traversal stack can overflow on tree with uint32 node indices");
+
+    // nearest queries keep squared box distance with node, so it is computed once per node
+    struct Nearest_Entry {
+        uint32_t node;
+        float distance_squared;
+    };
+    using Nearest_Stack = std::array<Nearest_Entry, STACK_SIZE>;
+
+    // outward normals of cone sides, box is outside cone if it is fully outside one of them
+    struct Cone_Sides {
+        glm::vec2 left;
+        glm::vec2 right;
+    };
+
+    [[nodiscard]]
+    static Cone_Sides cone_sides(const Cone& cone);
+
+    [[nodiscard]]
+    static bool outside(const Box& b, glm::vec2 apex, const Cone_Sides& sides)
+    {
+        // box corner farthest inside along normal
+        auto inside_most = [&](glm::vec2 n) { return glm::vec2{n.x > 0.0f ? b.min.x : b.max.x, n.y > 0.0f ? b.min.y : b.max.y}; };
+        return glm::dot(inside_most(sides.left) - apex, sides.left) > 0.0f ||
+               glm::dot(inside_most(sides.right) - apex, sides.right) > 0.0f;
+    }
+
+    // nearest and nearest_in_cone, no cone if sides is null
+    template <typename Distance>
+    [[nodiscard]]
+    std::optional<Nearest_Hit> nearest_impl(glm::vec2 point, const Cone_Sides* sides, Distance& distance_to, float max_distance) const;
+
+    template <typename Distance>
+    [[nodiscard]]
+    std::optional<Nearest_Hit> nearest_wrapped_impl(glm::vec2 point, const Cone_Sides* sides, glm::vec2 world_size,
+                                                    Distance& distance_to, float max_distance) const;
+
+    // point and its 8 shifts by world size, unshifted first
+    [[nodiscard]]
+    static std::array<glm::vec2, 9> wrapped_points(glm::vec2 point, glm::vec2 world_size);
+
+    // k_nearest without clearing out, hit already in out is kept with smaller distance
+    template <typename Distance>
+    void k_nearest_into(glm::vec2 point, std::size_t k, Distance& distance_to, std::vector<Nearest_Hit>& out,
+                        float max_distance) const;
+
+    [[nodiscard]]
+    uint32_t allocate_node();
+    void free_node(uint32_t node);
+
+    void insert_leaf(uint32_t leaf);
+    void remove_leaf(uint32_t leaf);
+
+    // fixes box and height of node and all its ancestors, rotating where needed
+    void refit(uint32_t node);
+
+    [[nodiscard]]
+    uint32_t balance(uint32_t node);
+
+    [[nodiscard]]
+    static Box to_box(const AABB_Collider& bounds)
+    { return {{bounds.pos.x, bounds.pos.y-bounds.size.y}, {bounds.pos.x+bounds.size.x, bounds.pos.y}}; }
+
+    [[nodiscard]]
+    static Box merge(const Box& a, const Box& b)
+    { return {glm::min(a.min, b.min), glm::max(a.max, b.max)}; }
+
+    [[nodiscard]]
+    static float perimeter(const Box& b)
+    { return 2.0f * ((b.max.x-b.min.x) + (b.max.y-b.min.y)); }
+
+    [[nodiscard]]
+    static bool overlaps(const Box& a, const Box& b)
+    { return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y; }
+
+    [[nodiscard]]
+    static bool contains(const Box& outer, const Box& inner)
+    { return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.max.x >= inner.max.x && outer.max.y >= inner.max.y; }
+
+    // squared distance from point to closest point of box, 0 if inside
+    [[nodiscard]]
+    static float distance_squared(const Box& b, glm::vec2 p)
+    {
+        const auto d = glm::max(glm::max(b.min - p, p - b.max), glm::vec2{0.0f});
+        return d.x*d.x + d.y*d.y;
+    }
+
+    // slab test, true if segment from + dir*t for t in [0, max_fraction] touches box
+    [[nodiscard]]
+    static bool segment_hits(const Box& b, glm::vec2 from, glm::vec2 dir, float max_fraction);
+
+private:
+    std::vector<Node> _nodes;
+    uint32_t _root{NONE};
+    uint32_t _free_list{NONE};
+    std::size_t _leaf_count{};
+    float _fat_margin;
+};
+
+template <typename Hit_Test>
+std::optional<Aabb_Tree::Ray_Hit> Aabb_Tree::ray_cast(glm::vec2 from, glm::vec2 to, Hit_Test&& hit_test) const
+{
+    std::optional<Ray_Hit> res;
+    if (_root == NONE) return res;
+
+    const auto dir = to - from;
+    auto max_fraction = 1.0f;
+
+    Stack stack;
+    std::size_t top{};
+    stack[top++] = _root;
+    while (top > 0) {
+        const auto& node = _nodes[stack[--top]];
+        if (!segment_hits(node.box, from, dir, max_fraction)) continue;
+
+        if (node.is_leaf()) {
+            // hit test gets clipped segment, so rescale its fraction
+            const std::optional<float> fraction = hit_test(node.user, from, from + dir*max_fraction);
+            if (fraction) {
+                max_fraction *= *fraction;
+                res = Ray_Hit{node.user, max_fraction};
+            }
+            continue;
+        }
+
+        // child nearer along segment is popped first, so first hit clips the rest early
+        auto first = node.child1;
+        auto second = node.child2;
+        auto along = [&](uint32_t child) { return glm::dot(_nodes[child].box.min + _nodes[child].box.max, dir); };
+        if (along(first) > along(second)) std::swap(first, second);
+
+        PERIA_ASSERT(top+2 <= STACK_SIZE, "Aabb_Tree stack overflow");
+        stack[top++] = second;
+        stack[top++] = first;
+    }
+    return res;
+}
+
+template <typename Distance>
+std::optional<Aabb_Tree::Nearest_Hit> Aabb_Tree::nearest(glm::vec2 point, Distance&& distance_to, float max_distance) const
+{ return nearest_impl(point, nullptr, distance_to, max_distance); }
+
+template <typename Distance>
+std::optional<Aabb_Tree::Nearest_Hit> Aabb_Tree::nearest_in_cone(glm::vec2 point, const Cone& cone, Distance&& distance_to, float max_distance) const
+{
+    const auto sides = cone_sides(cone);
+    return nearest_impl(point, &sides, distance_to, max_distance);
+}
+
+template <typename Distance>
+std::optional<Aabb_Tree::Nearest_Hit> Aabb_Tree::nearest_impl(glm::vec2 point, const Cone_Sides* sides, Distance& distance_to, float max_distance) const
+{
+    std::optional<Nearest_Hit> res;
+    if (_root == NONE) return res;
+
+    auto best = max_distance;
+
+    Nearest_Stack stack;
+    std::size_t top{};
+    stack[top++] = {_root, distance_squared(_nodes[_root].box, point)};
+    while (top > 0) {
+        const auto entry = stack[--top];
+        if (entry.distance_squared > best*best) continue;
+
+        const auto& node = _nodes[entry.node];
+        if (sides && outside(node.box, point, *sides)) continue;
+
+        if (node.is_leaf()) {
+            const float d = distance_to(node.user);
+            if (d <= best) {
+                best = d;
+                res = Nearest_Hit{node.user, d};
+            }
+            continue;
+        }
+
+        // closer child is popped first, so 'best' shrinks early
+        Nearest_Entry first{node.child1, distance_squared(_nodes[node.child1].box, point)};
+        Nearest_Entry second{node.child2, distance_squared(_nodes[node.child2].box, point)};
+        if (first.distance_squared > second.distance_squared) std::swap(first, second);
+
+        PERIA_ASSERT(top+2 <= STACK_SIZE, "Aabb_Tree stack overflow");
+        stack[top++] = second;
+        stack[top++] = first;
+    }
+    return res;
+}
+
+template <typename Distance>
+void Aabb_Tree::k_nearest(glm::vec2 point, std::size_t k, Distance&& distance_to, std::vector<Nearest_Hit>& out, float max_distance) const
+{
+    out.clear();
+    k_nearest_into(point, k, distance_to, out, max_distance);
+}
+
+template <typename Distance>
+void Aabb_Tree::k_nearest_into(glm::vec2 point, std::size_t k, Distance& distance_to, std::vector<Nearest_Hit>& out, float max_distance) const
+{
+    if (_root == NONE || k == 0) return;
+
+    // out is sorted by distance, once it is full its last hit bounds the search
+    auto bound = [&] { return out.size() < k ? max_distance : std::min(max_distance, out.back().distance); };
+
+    Nearest_Stack stack;
+    std::size_t top{};
+    stack[top++] = {_root, distance_squared(_nodes[_root].box, point)};
+    while (top > 0) {
+        const auto entry = stack[--top];
+        if (entry.distance_squared > bound()*bound()) continue;
+
+        const auto& node = _nodes[entry.node];
+        if (node.is_leaf()) {
+            const float d = distance_to(node.user);
+            if (d > bound()) continue;
+
+            const auto same_user = std::find_if(out.begin(), out.end(), [&](const Nearest_Hit& h) { return h.user == node.user; });
+            if (same_user != out.end()) {
+                if (same_user->distance <= d) continue;
+                out.erase(same_user);
+            }
+            else if (out.size() == k) {
+                out.pop_back();
+            }
+            const auto at = std::upper_bound(out.begin(), out.end(), d, [](float v, const Nearest_Hit& h) { return v < h.distance; });
+            out.insert(at, Nearest_Hit{node.user, d});
+            continue;
+        }
+
+        Nearest_Entry first{node.child1, distance_squared(_nodes[node.child1].box, point)};
+        Nearest_Entry second{node.child2, distance_squared(_nodes[node.child2].box, point)};
+        if (first.distance_squared > second.distance_squared) std::swap(first, second);
+
+        PERIA_ASSERT(top+2 <= STACK_SIZE, "Aabb_Tree stack overflow");
+        stack[top++] = second;
+        stack[top++] = first;
+    }
+}
+
+template <typename Distance>
+std::optional<Aabb_Tree::Nearest_Hit> Aabb_Tree::nearest_wrapped(glm::vec2 point, glm::vec2 world_size, Distance&& distance_to, float max_distance) const
+{ return nearest_wrapped_impl(point, nullptr, world_size, distance_to, max_distance); }
+
+template <typename Distance>
+std::optional<Aabb_Tree::Nearest_Hit> Aabb_Tree::nearest_in_cone_wrapped(glm::vec2 point, const Cone& cone, glm::vec2 world_size,
+                                                                         Distance&& distance_to, float max_distance) const
+{
+    const auto sides = cone_sides(cone);
+    return nearest_wrapped_impl(point, &sides, world_size, distance_to, max_distance);
+}
+
+template <typename Distance>
+std::optional<Aabb_Tree::Nearest_Hit> Aabb_Tree::nearest_wrapped_impl(glm::vec2 point, const Cone_Sides* sides, glm::vec2 world_size,
+                                                                      Distance& distance_to, float max_distance) const
+{
+    std::optional<Nearest_Hit> res;
+    for (const auto p:wrapped_points(point, world_size)) {
+        auto shifted = [&](uint32_t user) { return distance_to(user, p); };
+        const auto hit = nearest_impl(p, sides, shifted, res ? res->distance : max_distance);
+        if (hit && (!res || hit->distance < res->distance)) res = hit;
+    }
+    return res;
+}
+
+template <typename Distance>
+void Aabb_Tree::k_nearest_wrapped(glm::vec2 point, glm::vec2 world_size, std::size_t k, Distance&& distance_to,
+                                  std::vector<Nearest_Hit>& out, float max_distance) const
+{
+    out.clear();
+    for (const auto p:wrapped_points(point, world_size)) {
+        auto shifted = [&](uint32_t user) { return distance_to(user, p); };
+        k_nearest_into(p, k, shifted, out, max_distance);
+    }
+}
+
+}
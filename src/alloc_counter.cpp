@@ -0,0 +1,98 @@
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+
+#include "peria_logger.hpp"
+
+#ifdef PERIA_DEBUG
+    #include <atomic>
+    #include <cstdlib>
+    #include <new>
+    #ifdef _MSC_VER
+        #include <malloc.h>
+    #endif
+
+namespace {
+    std::atomic<std::size_t> allocation_count{0};
+}
+
+// array and nothrow versions of operator new forward here
+void* operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{ std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept
+{ std::free(p); }
+
+// over aligned types and std::pmr::new_delete_resource() allocate through these,
+// array and nothrow versions forward here too
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    const auto alignment = static_cast<std::size_t>(align);
+#ifdef _MSC_VER
+    if (auto* p = _aligned_malloc(size == 0 ? 1 : size, alignment)) return p;
+#else
+    // aligned_alloc wants size to be multiple of alignment
+    const auto rounded = (std::max<std::size_t>(size, 1) + alignment-1) / alignment * alignment;
+    if (auto* p = std::aligned_alloc(alignment, rounded)) return p;
+#endif
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept
+{ operator delete(p, align); }
+
+namespace peria {
+
+std::size_t heap_allocations()
+{ return allocation_count.load(std::memory_order_relaxed); }
+
+}
+#else
+
+namespace peria {
+
+std::size_t heap_allocations()
+{ return 0; }
+
+}
+#endif
+
+namespace peria {
+
+void Tick_Allocations::end_tick()
+{
+    _last = heap_allocations() - _start;
+    ++_ticks;
+    _allocating_ticks += _last > 0;
+    _total += _last;
+    _max = std::max(_max, _last);
+
+    if (_ticks < _window) return;
+    if (_allocating_ticks > 0) {
+        PERIA_LOG("heap allocations: ", _allocating_ticks, " of ", _ticks, " ticks allocated, ",
+                  _total, " in total, at most ", _max, " in one tick");
+    }
+    _ticks = 0;
+    _allocating_ticks = 0;
+    _total = 0;
+    _max = 0;
+}
+
+}
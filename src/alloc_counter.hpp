@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+namespace peria {
+
+// Number of calls to global operator new since program start.
+// Counting is only compiled in debug builds, release builds always return 0.
+// Used to check that hot paths (collision code) do not allocate in steady state.
+[[nodiscard]]
+std::size_t heap_allocations();
+
+// Heap allocations of every fixed step. Every 'window' ticks logs how many ticks allocated
+// and most allocations in one tick, so allocating code on tick path shows up in debug builds.
+// In release builds heap_allocations() is 0, so nothing is ever reported.
+class Tick_Allocations {
+public:
+    explicit Tick_Allocations(std::size_t window = 600)
+        :_window{window}
+    {}
+
+    void begin_tick()
+    { _start = heap_allocations(); }
+
+    void end_tick();
+
+    // allocations of last finished tick
+    [[nodiscard]]
+    std::size_t last() const
+    { return _last; }
+
+private:
+    std::size_t _window;
+    std::size_t _start{};
+    std::size_t _last{};
+
+    // since last report
+    std::size_t _ticks{};
+    std::size_t _allocating_ticks{};
+    std::size_t _total{};
+    std::size_t _max{};
+};
+
+}
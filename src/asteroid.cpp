@@ -2,11 +2,14 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 
 #include "graphics.hpp"
+#include "opengl_errors.hpp"
 #include "physics.hpp"
 #include "game.hpp"
 #include "peria_utils.hpp"
+#include "vertex_batch.hpp"
 
 std::array<float, 3> get_speed {
     250.0f,
@@ -28,175 +31,239 @@ std::vector<std::vector<glm::vec2>> predefined_models_small {
     {{-0.444375f, 0.373333f}, {-0.2075f, 0.478889f}, {0.36625f, 0.274444f}, {0.37375f, -0.197778f}, {0.20125f, -0.0744444f}, {0.1675f, -0.454444f}, {-0.0525f, -0.197778f}, {-0.2225f, -0.196667f}, {-0.47875f, -0.44f}, {-0.4375f, -0.01f}},
 };
 
-std::vector<glm::vec2> Asteroid::init_asteroid_model(Asteroid_Type type)
+const std::vector<std::vector<glm::vec2>>& Asteroid::get_models(Asteroid_Type type)
 {
-    if (type == Asteroid_Type::LARGE)       return predefined_models[peria::get_int(0, predefined_models.size()-1)];
-    else if (type == Asteroid_Type::MEDIUM) return predefined_models_medium[peria::get_int(0, predefined_models_medium.size()-1)];
-    else                                    return predefined_models_small[peria::get_int(0, predefined_models_small.size()-1)];
+    if (type == Asteroid::Asteroid_Type::LARGE)       return predefined_models;
+    else if (type == Asteroid::Asteroid_Type::MEDIUM) return predefined_models_medium;
+    else                                              return predefined_models_small;
 }
 
-Asteroid::Asteroid(Asteroid_Type asteroid_type, glm::vec2 pos, glm::vec2 dir_vector, uint8_t level_id)
-    :_type{asteroid_type},
-     _transform{pos, {}, 0.0f}, 
-     _prev_transform{_transform},
-     _velocity{dir_vector},
-     _angle_rotation_speed{peria::get_float(20.0f, 35.0f)},
-     _level_id{level_id}, _dead{false},
-     _asteroid_model{init_asteroid_model(asteroid_type)}
+namespace {
+
+// Every predefined model with its convex pieces, axes and bounding radius, in model space.
+// Decomposed once on first use, asteroids only transform them per tick.
+// Rotation and positive scale keep winding and convexity, so pieces
+// in world space are the same as triangulating world space polygon.
+struct Model_Table {
+    std::vector<Asteroid_Model> models;
+    std::array<Asteroid::Model_Id, 3> first{}; // id of first model of each Asteroid_Type
+    std::array<Asteroid::Model_Id, 3> count{};
+};
+
+const Model_Table& model_table()
 {
-    auto largest_hp = [this]() -> uint8_t {
-        if (_level_id == 1) return 3;
-        if (_level_id == 2) return 4;
-        if (_level_id == 3) return 5;
-        if (_level_id == 4) return 3;
-        if (_level_id == 5) return 4;
-        return 0;
+    static const auto table = []() {
+        Model_Table res;
+        for (auto t:{Asteroid::Asteroid_Type::SMALL, Asteroid::Asteroid_Type::MEDIUM, Asteroid::Asteroid_Type::LARGE}) {
+            const auto& outlines = Asteroid::get_models(t);
+            res.first[int(t)] = static_cast<Asteroid::Model_Id>(res.models.size());
+            res.count[int(t)] = static_cast<Asteroid::Model_Id>(outlines.size());
+            for (const auto& outline:outlines) {
+                auto& model = res.models.emplace_back(Asteroid_Model{outline, peria::make_convex_model(outline), 0.0f});
+                for (const auto& p:outline) model.radius = std::max(model.radius, glm::length(p));
+            }
+        }
+        return res;
     }();
+    return table;
+}
+
+// random model of given type
+Asteroid::Model_Id random_model(Asteroid::Asteroid_Type type)
+{ return Asteroid::get_model_id(type, peria::get_int(0, Asteroid::get_models(type).size()-1)); }
 
-    auto random_speed_offset = peria::get_int(-20, 20);
-    switch (_type) {
-        case Asteroid_Type::SMALL:
-            _transform.scale = {70.0f, 70.0f};
-            _velocity *= get_speed[int(Asteroid_Type::SMALL)]+random_speed_offset;
-            _hp = largest_hp-2;
-            break;
-        case Asteroid_Type::MEDIUM:
-            _transform.scale = {180.0f, 180.0f};
-            _velocity *= get_speed[int(Asteroid_Type::MEDIUM)] + random_speed_offset;
-            _hp = largest_hp-1;
-            break;
-        case Asteroid_Type::LARGE:
-            _transform.scale = {250.0f, 250.0f};
-            _velocity *= get_speed[int(Asteroid_Type::LARGE)] + random_speed_offset;
-            _hp = largest_hp;
-            break;
-        default:
-            _transform.scale = {};
-    }
 }
 
-void Asteroid::update(float dt)
+const peria::Convex_Model& Asteroid::get_convex_pieces(Asteroid_Type type, std::size_t model_index)
+{ return get_shared_model(get_model_id(type, model_index)).convex; }
+
+Asteroid::Model_Id Asteroid::get_model_id(Asteroid_Type type, std::size_t model_index)
 {
-    // store prev state
-    _prev_transform = _transform;
+    const auto& table = model_table();
+    PERIA_ASSERT(model_index < table.count[int(type)], "asteroid model index out of range");
+    return static_cast<Model_Id>(table.first[int(type)] + model_index);
+}
 
-    _transform.angle += _angle_rotation_speed*dt;
-    Transform::clamp_angle(_transform.angle);
+const Asteroid_Model& Asteroid::get_shared_model(Model_Id id)
+{ return model_table().models[id]; }
 
-    _transform.pos += _velocity*dt;
+void Asteroid::set_color(glm::vec4 color)
+{ _pool->_color_overrides.emplace_back(get_id(), color); }
 
-    // screen wrap
-    auto world_pos = get_points_in_world();
-    auto min_x = std::min_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.x<b.x;})->x;
-    auto max_x = std::max_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.x<b.x;})->x;
-    auto min_y = std::min_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.y<b.y;})->y;
-    auto max_y = std::max_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.y<b.y;})->y;
-    
-    const auto [w, h] = Game::get_world_size();
+void Asteroid::draw(Graphics& g, float alpha, std::span<const glm::vec2> world_outline) const
+{ 
+    g.draw_polygon(world_outline, _pool->color(_i)); 
+    g.draw_text(std::to_string(hp()), get_interpolated_transform(alpha).pos, {0.2f, 0.2f, 0.4f}, 48, 0.5f);
+}
 
-    bool wrap = false;
+Asteroid_Pool::Asteroid_Pool(std::pmr::memory_resource* collider_mem)
+    :_collider_mem{collider_mem}
+{}
 
-    if (min_x > w) {
-        _transform.pos.x -= (w+max_x-min_x);
-        wrap = true;
-    }
-    else if (max_x < 0.0f) {
-        _transform.pos.x += (w+max_x-min_x);
-        wrap = true;
-    }
+std::size_t Asteroid_Pool::spawn(Asteroid_Type type, glm::vec2 pos, glm::vec2 dir, uint8_t level_id)
+{
+    const auto largest_hp = [level_id]() -> uint8_t {
+        if (level_id == 1) return 3;
+        if (level_id == 2) return 4;
+        if (level_id == 3) return 5;
+        if (level_id == 4) return 3;
+        if (level_id == 5) return 4;
+        return 0;
+    }();
 
-    if (min_y > h) {
-        _transform.pos.y -= (h+max_y-min_y);
-        wrap = true;
-    }
-    else if (max_y < 0.0f) {
-        _transform.pos.y += (h+max_y-min_y);
-        wrap = true;
+    const auto model_id = random_model(type);
+    const auto angular_speed = peria::get_float(20.0f, 35.0f);
+    const auto speed = get_speed[int(type)] + peria::get_int(-20, 20);
+    float scale{};
+    uint8_t hp{};
+    switch (type) {
+        case Asteroid_Type::SMALL:
+            scale = 70.0f;
+            hp = largest_hp-2;
+            break;
+        case Asteroid_Type::MEDIUM:
+            scale = 180.0f;
+            hp = largest_hp-1;
+            break;
+        case Asteroid_Type::LARGE:
+            scale = 250.0f;
+            hp = largest_hp;
+            break;
     }
 
-    if (wrap) _prev_transform = _transform;
+    const auto& model = Asteroid::get_shared_model(model_id);
+    _pos.push_back(pos);
+    _prev_pos.push_back(pos);
+    _velocity.push_back(dir*speed);
+    _angle.push_back(0.0f);
+    _angular_speed.push_back(angular_speed);
+    _cold.push_back({scale, type, model_id, hp, level_id, false});
+    // scale is uniform and does not change, so radius is computed once
+    _colliders.push_back({std::pmr::vector<peria::Small_Polygon>(model.convex.indices.size(), _collider_mem),
+                          {pos, model.radius*scale, {}}, peria::Aabb_Tree::NONE, {}, peria::new_entity_id()});
 
-    reset_color();
+    const auto i = size()-1;
+    std::array<glm::vec2, peria::Small_Polygon::CAPACITY> world_outline;
+    peria::transform_points(peria::Affine_2d::from((*this)[i].get_transform()), model.outline, world_outline);
+    update_collider(i, std::span{world_outline}.first(model.outline.size()));
+    return i;
 }
 
-void Asteroid::draw(Graphics& g, float alpha) const
-{ 
-    //g.draw_polygon(get_points_in_world(), _color);
-    auto t = peria::interpolate_state(_prev_transform, _transform, alpha);
-    g.draw_polygon(get_points_in_world_interpolated(t), _color); 
+void Asteroid_Pool::update(float dt)
+{
+    _color_overrides.clear();
 
-    g.draw_text(std::to_string(_hp), t.pos, {0.2f, 0.2f, 0.4f}, 48, 0.5f);
+    const auto n = size();
+    auto* pos = _pos.data();
+    auto* prev_pos = _prev_pos.data();
+    const auto* velocity = _velocity.data();
+    auto* angle = _angle.data();
+    const auto* angular_speed = _angular_speed.data();
+    for (std::size_t i{}; i<n; ++i) {
+        prev_pos[i] = pos[i];
+        pos[i] += velocity[i]*dt;
+        angle[i] += angular_speed[i]*dt;
+        Transform::clamp_angle(angle[i]);
+    }
 }
 
-void Asteroid::explode()
-{ _dead = true; }
+void Asteroid_Pool::update_collider(std::size_t i, std::span<const glm::vec2> world_outline)
+{
+    auto& c = _colliders[i];
+    const auto transform = (*this)[i].get_transform();
+    peria::to_world(Asteroid::get_shared_model(_cold[i].model_id).convex, transform, world_outline, c.world_pieces);
+    c.bounds.center = transform.pos;
+    c.bounds.aabb = peria::aabb_of(c.world_pieces);
 
-glm::vec2 Asteroid::get_world_pos() const
-{ return _transform.pos; }
+    // screen wrap only moves asteroid, so collider is moved along instead of rebuilt
+    const auto [w, h] = Game::get_world_size();
+    const auto offset = peria::screen_wrap_offset(c.bounds.aabb, {w, h});
+    if (offset != glm::vec2{0.0f}) {
+        _pos[i] += offset;
+        _prev_pos[i] = _pos[i];
+        peria::translate(c.world_pieces, offset);
+        c.bounds.center += offset;
+        c.bounds.aabb.pos += offset;
+    }
+}
 
-bool Asteroid::dead() const 
-{ return _dead; }
+std::size_t Asteroid_Pool::split(std::size_t i)
+{
+    // copied, spawn may reallocate arrays
+    const auto pos = _pos[i];
+    const auto level_id = _cold[i].level_id;
+    const auto type = _cold[i].type;
 
-uint8_t Asteroid::hp() const
-{ return _hp; }
+    auto spawn_children = [&](Asteroid_Type child, std::size_t count) {
+        const auto angle = 360.0f / count;
+        for (std::size_t k{}; k<count; ++k) {
+            auto direction = glm::vec2{std::cos(glm::radians(k*angle)), std::sin(glm::radians(k*angle))};
+            auto offset = direction*10.0f;
+            spawn(child, pos+offset, direction, level_id);
+        }
+        return count;
+    };
 
-void Asteroid::hit()
-{ if (_hp > 0) --_hp; }
+    switch(type) {
+        case Asteroid_Type::SMALL:
+            return 0;
+        case Asteroid_Type::MEDIUM:
+            return spawn_children(Asteroid_Type::SMALL, 6);
+        case Asteroid_Type::LARGE:
+            return spawn_children(Asteroid_Type::MEDIUM, 3);
+    }
+    return 0;
+}
 
-std::vector<glm::vec2> Asteroid::get_points_in_world() const
+void Asteroid_Pool::remove(std::size_t i)
 {
-    std::vector<glm::vec2> vec; vec.reserve(_asteroid_model.size());
-    auto transform = Transform::model(_transform.pos, _transform.scale, _transform.angle);
-    for (const auto& p:_asteroid_model) {
-        glm::vec4 v{p.x, p.y, 0.0f, 1.0f};
-        glm::vec4 transformed = transform*v;
-        vec.emplace_back(transformed.x, transformed.y);
+    const auto last = size()-1;
+    if (i != last) {
+        _pos[i] = _pos[last];
+        _prev_pos[i] = _prev_pos[last];
+        _velocity[i] = _velocity[last];
+        _angle[i] = _angle[last];
+        _angular_speed[i] = _angular_speed[last];
+        _cold[i] = _cold[last];
+        _colliders[i] = std::move(_colliders[last]);
     }
-    return vec;
+    _pos.pop_back();
+    _prev_pos.pop_back();
+    _velocity.pop_back();
+    _angle.pop_back();
+    _angular_speed.pop_back();
+    _cold.pop_back();
+    _colliders.pop_back();
 }
 
-std::vector<glm::vec2> Asteroid::get_points_in_world_interpolated(const Transform& interpolated_transform) const
+void Asteroid_Pool::reserve(std::size_t capacity)
 {
-    std::vector<glm::vec2> vec; vec.reserve(_asteroid_model.size());
-    auto interpolated_model = Transform::model(interpolated_transform.pos, interpolated_transform.scale, _transform.angle);
-    for (const auto& p:_asteroid_model) {
-        glm::vec4 v{p.x, p.y, 0.0f, 1.0f};
-        glm::vec4 transformed = interpolated_model*v;
-        vec.emplace_back(transformed.x, transformed.y);
-    }
-    return vec;
+    _pos.reserve(capacity);
+    _prev_pos.reserve(capacity);
+    _velocity.reserve(capacity);
+    _angle.reserve(capacity);
+    _angular_speed.reserve(capacity);
+    _cold.reserve(capacity);
+    _colliders.reserve(capacity);
 }
 
-std::vector<Asteroid> Asteroid::split()
+void Asteroid_Pool::clear()
 {
-    std::vector<Asteroid> asteroids;
-    asteroids.reserve(6); // will spawn at most 6 asteroids
+    _pos.clear();
+    _prev_pos.clear();
+    _velocity.clear();
+    _angle.clear();
+    _angular_speed.clear();
+    _cold.clear();
+    _colliders.clear();
+    _color_overrides.clear();
+}
 
-    switch(_type) {
-        case Asteroid_Type::SMALL:
-            break;
-        case Asteroid_Type::MEDIUM:
-            {
-                auto angle = 360.0f / 6;
-                for (std::size_t i{}; i<6; ++i) {
-                    auto direction = glm::vec2{std::cos(glm::radians(i*angle)), std::sin(glm::radians(i*angle))};
-                    auto offset = direction*10.0f;
-                    asteroids.emplace_back(Asteroid_Type::SMALL, _transform.pos+offset, 
-                            direction, _level_id);
-                }
-                break;
-            }
-        case Asteroid_Type::LARGE:
-            {
-                auto angle = 360.0f / 3;
-                for (std::size_t i{}; i<3; ++i) {
-                    auto direction = glm::vec2{std::cos(glm::radians(i*angle)), std::sin(glm::radians(i*angle))};
-                    auto offset = direction*10.0f;
-                    asteroids.emplace_back(Asteroid_Type::MEDIUM, _transform.pos+offset, 
-                            direction, _level_id);
-                }
-                break;
-            }
+glm::vec4 Asteroid_Pool::color(std::size_t i) const
+{
+    const auto id = _colliders[i].id;
+    for (const auto& [override_id, color]:_color_overrides) {
+        if (override_id == id) return color;
     }
-    return asteroids;
+    return {0.8f, 0.8f, 0.8f, 1.0f};
 }
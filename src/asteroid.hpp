@@ -1,36 +1,57 @@
 #pragma once
 
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <utility>
 #include <vector>
 #include "transform.hpp"
+#include "physics.hpp"
+#include "aabb_tree.hpp"
+#include "handle_pool.hpp"
+#include "peria_utils.hpp"
 
 class Graphics;
+class Asteroid_Pool;
 
+// Outline and collision data of one predefined asteroid model, shared by every asteroid
+// that uses it. Built once on first use and never changed, asteroids only keep its id.
+struct Asteroid_Model {
+    std::vector<glm::vec2> outline; // model space, clockwise
+    peria::Convex_Model convex; // convex pieces of outline and their axes
+    float radius{}; // of bounding circle around origin, model space
+};
+
+// View of one asteroid in Asteroid_Pool, valid as long as pool and index are.
+// Const view only reads, same as Bullet.
 class Asteroid {
 public:
-    enum class Asteroid_Type {
+    enum class Asteroid_Type : uint8_t {
         SMALL = 0,
         MEDIUM,
         LARGE,
     };
 
-    Asteroid() = default;
-
-    // pos - initial world pos.
-    // dir_vector - normalized direction vector.
-    Asteroid(Asteroid_Type asteroid_type, glm::vec2 pos, glm::vec2 dir_vector, uint8_t level_id);
+    // index into shared model table, see 'get_shared_model'
+    using Model_Id = uint8_t;
 
-    void update(float dt);
-    void draw(Graphics& g, float alpha) const;
+    Asteroid(Asteroid_Pool& pool, std::size_t index)
+        :_pool{&pool}, _i{index}
+    {}
 
-    void set_color(glm::vec4 color) 
-    { _color = color; }
+    // world_outline is model moved by interpolated transform (see Vertex_Batch)
+    void draw(Graphics& g, float alpha, std::span<const glm::vec2> world_outline) const;
 
-    void reset_color()
-    { _color = {0.8f, 0.8f, 0.8f, 1.0f}; }
+    // color until next 'Asteroid_Pool::update'
+    void set_color(glm::vec4 color);
 
     [[nodiscard]]
     glm::vec2 get_world_pos() const;
 
+    // stable id, keys per pair caches
+    [[nodiscard]]
+    uint32_t get_id() const;
+
     [[nodiscard]]
     bool dead() const;
 
@@ -41,33 +62,307 @@ public:
 
     void hit();
 
+    // polygon in model space
+    [[nodiscard]]
+    std::span<const glm::vec2> get_model() const
+    { return get_shared_model(get_model_id()).outline; }
+
+    [[nodiscard]]
+    Model_Id get_model_id() const;
+
+    [[nodiscard]]
+    Asteroid_Type get_type() const;
+
     [[nodiscard]]
-    std::vector<glm::vec2> get_points_in_world() const;
+    Transform get_transform() const;
 
+    // world units and degrees per second
     [[nodiscard]]
-    std::vector<glm::vec2> get_points_in_world_interpolated(const Transform& interpolated_transform) const;
+    glm::vec2 get_velocity() const;
 
     [[nodiscard]]
-    std::vector<Asteroid> split();
+    float get_angular_speed() const;
+
+    // transform between previous and current tick, for drawing
+    [[nodiscard]]
+    Transform get_interpolated_transform(float alpha) const;
+
+    // convex pieces of asteroid polygon in world space, updated once per tick
+    [[nodiscard]]
+    std::span<const peria::Small_Polygon> get_convex_pieces_in_world() const;
+
+    // bounding circle and aabb in world space, updated once per tick
+    [[nodiscard]]
+    const peria::Bounds& get_bounds() const;
+
+    // collider tree proxy, managed by Game. NONE until asteroid is inserted
+    [[nodiscard]]
+    peria::Aabb_Tree::Proxy get_broadphase_proxy() const;
+
+    void set_broadphase_proxy(peria::Aabb_Tree::Proxy proxy);
+
+    // generational handle, managed by Game. not valid until asteroid is synced first time
+    [[nodiscard]]
+    peria::Handle get_handle() const;
+
+    void set_handle(peria::Handle handle);
+
+    // asteroid and all asteroids it can split into (LARGE -> 3 MEDIUM -> 18 SMALL)
+    [[nodiscard]]
+    static constexpr std::size_t split_tree_size(Asteroid_Type type)
+    {
+        switch (type) {
+            case Asteroid_Type::SMALL:  return 1;
+            case Asteroid_Type::MEDIUM: return 1 + 6*split_tree_size(Asteroid_Type::SMALL);
+            case Asteroid_Type::LARGE:  return 1 + 3*split_tree_size(Asteroid_Type::MEDIUM);
+        }
+        return 1;
+    }
+
+    // predefined models of given type, in model space
+    [[nodiscard]]
+    static const std::vector<std::vector<glm::vec2>>& get_models(Asteroid_Type type);
+
+    // cached convex decomposition of get_models(type)[model_index] and its axes, in model space
+    [[nodiscard]]
+    static const peria::Convex_Model& get_convex_pieces(Asteroid_Type type, std::size_t model_index);
+
+    // id of get_models(type)[model_index] in shared model table
+    [[nodiscard]]
+    static Model_Id get_model_id(Asteroid_Type type, std::size_t model_index);
+
+    [[nodiscard]]
+    static const Asteroid_Model& get_shared_model(Model_Id id);
 
 private:
+    Asteroid_Pool* _pool;
+    std::size_t _i;
+};
+
+// All asteroids of level, split by how often state is touched.
+// Hot: position, previous position, velocity, angle and angular speed, in packed arrays
+// 'update' walks every tick. Cold: hp, type, model id and the rest, in one small record
+// per asteroid. Collider: world space pieces, bounds and broadphase state.
+// Color overrides live in short list cleared by 'update', most asteroids have none.
+// Dead asteroids are removed by moving last one into their place, so indices change in
+// 'remove_dead' and nowhere else, children of 'split' are appended.
+class Asteroid_Pool {
+public:
+    using Asteroid_Type = Asteroid::Asteroid_Type;
+
+    // collider_mem - storage of world space convex pieces, Game pools them so split doesn't allocate
+    explicit Asteroid_Pool(std::pmr::memory_resource* collider_mem = std::pmr::get_default_resource());
+
+    // pos - initial world pos, dir - normalized direction vector. returns index of asteroid
+    std::size_t spawn(Asteroid_Type type, glm::vec2 pos, glm::vec2 dir, uint8_t level_id);
+
+    // moves asteroids, colliders follow in 'update_collider'
+    void update(float dt);
+
+    // Rebuilds convex pieces and bounds of asteroid i from model outline moved to world space by current
+    // transform (see Vertex_Batch), then wraps asteroid around world edges. Once per tick after 'update'.
+    void update_collider(std::size_t i, std::span<const glm::vec2> world_outline);
+
+    // Builds 0, 3 or 6 smaller asteroids of asteroid i at end of pool, returns how many.
+    // Reserve with 'Asteroid::split_tree_size' so it never allocates.
+    std::size_t split(std::size_t i);
+
+    // calls on_remove(asteroid) for every dead asteroid, then moves last asteroid into its place
+    template <typename F>
+    void remove_dead(F&& on_remove);
+
+    void reserve(std::size_t capacity);
+    void clear();
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _pos.size(); }
 
     [[nodiscard]]
-    std::vector<glm::vec2> init_asteroid_model(Asteroid_Type type);
+    bool empty() const
+    { return _pos.empty(); }
+
+    [[nodiscard]]
+    Asteroid operator[](std::size_t i)
+    { return {*this, i}; }
+
+    [[nodiscard]]
+    const Asteroid operator[](std::size_t i) const
+    { return {const_cast<Asteroid_Pool&>(*this), i}; }
+
+    // iterates views, use 'auto a' or 'const auto& a'
+    template <typename Pool>
+    class Iterator {
+    public:
+        Iterator(Pool* pool, std::size_t i)
+            :_pool{pool}, _i{i}
+        {}
+
+        auto operator*() const
+        { return (*_pool)[_i]; }
+
+        Iterator& operator++()
+        { ++_i; return *this; }
+
+        bool operator==(const Iterator&) const = default;
+
+    private:
+        Pool* _pool;
+        std::size_t _i;
+    };
+
+    [[nodiscard]]
+    Iterator<Asteroid_Pool> begin()
+    { return {this, 0}; }
+
+    [[nodiscard]]
+    Iterator<Asteroid_Pool> end()
+    { return {this, size()}; }
+
+    [[nodiscard]]
+    Iterator<const Asteroid_Pool> begin() const
+    { return {this, 0}; }
+
+    [[nodiscard]]
+    Iterator<const Asteroid_Pool> end() const
+    { return {this, size()}; }
 
 private:
-    Asteroid_Type _type;
-    Transform _transform{};
-    Transform _prev_transform{};
+    friend class Asteroid;
+
+    struct Cold {
+        float scale; // uniform
+        Asteroid_Type type;
+        Asteroid::Model_Id model_id;
+        uint8_t hp; // this many hits to destroy
+        uint8_t level_id;
+        bool dead;
+    };
+
+    struct Collider_State {
+        std::pmr::vector<peria::Small_Polygon> world_pieces; // one per piece of model, sized once
+        peria::Bounds bounds;
+        peria::Aabb_Tree::Proxy proxy;
+        peria::Handle handle;
+        uint32_t id;
+    };
+
+    // last asteroid takes place of asteroid i
+    void remove(std::size_t i);
 
-    glm::vec2 _velocity{};
-    float _angle_rotation_speed{};
+    [[nodiscard]]
+    glm::vec4 color(std::size_t i) const;
+
+private:
+    // hot
+    std::vector<glm::vec2> _pos;
+    std::vector<glm::vec2> _prev_pos;
+    std::vector<glm::vec2> _velocity;
+    std::vector<float> _angle; // degrees, not interpolated since it jumps at 360
+    std::vector<float> _angular_speed;
 
-    uint8_t _hp; // this many hits to destroy
-    uint8_t _level_id;
-    bool _dead{};
+    std::vector<Cold> _cold;
+    std::vector<Collider_State> _colliders;
+    std::vector<std::pair<uint32_t, glm::vec4>> _color_overrides; // asteroid id, color
 
-    glm::vec4 _color = glm::vec4{0.8f, 0.8f, 0.8f, 1.0f};
+    std::pmr::memory_resource* _collider_mem;
 
-    std::vector<glm::vec2> _asteroid_model;
+public:
+    // bytes per asteroid 'update' walks, and the rest (besides convex pieces)
+    static constexpr std::size_t HOT_BYTES = 3*sizeof(glm::vec2) + 2*sizeof(float);
+    static constexpr std::size_t COLD_BYTES = sizeof(Cold) + sizeof(Collider_State);
 };
+
+template <typename F>
+void Asteroid_Pool::remove_dead(F&& on_remove)
+{
+    std::size_t i{};
+    while (i < size()) {
+        if (!_cold[i].dead) {
+            ++i;
+            continue;
+        }
+        on_remove(std::as_const(*this)[i]);
+        remove(i);
+    }
+}
+
+inline
+glm::vec2 Asteroid::get_world_pos() const
+{ return _pool->_pos[_i]; }
+
+inline
+uint32_t Asteroid::get_id() const
+{ return _pool->_colliders[_i].id; }
+
+inline
+bool Asteroid::dead() const
+{ return _pool->_cold[_i].dead; }
+
+inline
+uint8_t Asteroid::hp() const
+{ return _pool->_cold[_i].hp; }
+
+inline
+void Asteroid::explode()
+{ _pool->_cold[_i].dead = true; }
+
+inline
+void Asteroid::hit()
+{ if (_pool->_cold[_i].hp > 0) --_pool->_cold[_i].hp; }
+
+inline
+Asteroid::Model_Id Asteroid::get_model_id() const
+{ return _pool->_cold[_i].model_id; }
+
+inline
+Asteroid::Asteroid_Type Asteroid::get_type() const
+{ return _pool->_cold[_i].type; }
+
+inline
+Transform Asteroid::get_transform() const
+{
+    const auto scale = _pool->_cold[_i].scale;
+    return {_pool->_pos[_i], {scale, scale}, _pool->_angle[_i]};
+}
+
+inline
+glm::vec2 Asteroid::get_velocity() const
+{ return _pool->_velocity[_i]; }
+
+inline
+float Asteroid::get_angular_speed() const
+{ return _pool->_angular_speed[_i]; }
+
+inline
+Transform Asteroid::get_interpolated_transform(float alpha) const
+{
+    // same as peria::interpolate_state, angle is not interpolated since it jumps at 360
+    // and scale doesn't change
+    const auto scale = _pool->_cold[_i].scale;
+    return {(1.0f - alpha)*_pool->_prev_pos[_i] + _pool->_pos[_i]*alpha, {scale, scale}, _pool->_angle[_i]};
+}
+
+inline
+std::span<const peria::Small_Polygon> Asteroid::get_convex_pieces_in_world() const
+{ return _pool->_colliders[_i].world_pieces; }
+
+inline
+const peria::Bounds& Asteroid::get_bounds() const
+{ return _pool->_colliders[_i].bounds; }
+
+inline
+peria::Aabb_Tree::Proxy Asteroid::get_broadphase_proxy() const
+{ return _pool->_colliders[_i].proxy; }
+
+inline
+void Asteroid::set_broadphase_proxy(peria::Aabb_Tree::Proxy proxy)
+{ _pool->_colliders[_i].proxy = proxy; }
+
+inline
+peria::Handle Asteroid::get_handle() const
+{ return _pool->_colliders[_i].handle; }
+
+inline
+void Asteroid::set_handle(peria::Handle handle)
+{ _pool->_colliders[_i].handle = handle; }
@@ -0,0 +1,1710 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "aabb_tree.hpp"
+#include "alloc_counter.hpp"
+#include "asteroid.hpp"
+#include "broadphase.hpp"
+#include "bullet.hpp"
+#include "frame_arena.hpp"
+#include "frame_pacer.hpp"
+#include "game.hpp"
+#include "gjk.hpp"
+#include "homing_bullet.hpp"
+#include "job_system.hpp"
+#include "physics.hpp"
+#include "ray_cast.hpp"
+#include "sat_cache.hpp"
+#include "sat_simd.hpp"
+#include "systems.hpp"
+#include "vertex_batch.hpp"
+#include "ship.hpp"
+#include "weapons.hpp"
+
+namespace {
+
+// fixed seed, so runs are comparable
+std::mt19937 bench_rng{1234};
+
+[[nodiscard]]
+float rand_float(float l, float r)
+{ return std::uniform_real_distribution<float>{l, r}(bench_rng); }
+
+// runs f 'repeat' times and returns average nanoseconds per call of f
+template <typename F>
+[[nodiscard]]
+double measure_ns(std::size_t repeat, F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i{}; i<repeat; ++i) f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / repeat;
+}
+
+// convex pieces of every predefined asteroid model, in model space
+[[nodiscard]]
+std::vector<peria::Polygon> all_model_pieces()
+{
+    std::vector<peria::Polygon> res;
+    for (auto t:{Asteroid::Asteroid_Type::SMALL, Asteroid::Asteroid_Type::MEDIUM, Asteroid::Asteroid_Type::LARGE}) {
+        for (std::size_t i{}; i<Asteroid::get_models(t).size(); ++i) {
+            const auto& pieces = Asteroid::get_convex_pieces(t, i).pieces;
+            res.insert(res.end(), pieces.begin(), pieces.end());
+        }
+    }
+    return res;
+}
+
+// random placement of given piece inside small area, so some of the pairs collide
+[[nodiscard]]
+peria::Small_Polygon random_world_piece(const peria::Polygon& model_piece)
+{
+    std::vector<peria::Small_Polygon> world;
+    const auto scale = rand_float(70.0f, 250.0f);
+    peria::to_world({model_piece}, {{rand_float(0.0f, 300.0f), rand_float(0.0f, 300.0f)}, {scale, scale}, rand_float(0.0f, 360.0f)}, world);
+    return world[0];
+}
+
+// moves asteroids and rebuilds their colliders from one vertex batch, same as Game does every tick
+void update_asteroids(Asteroid_Pool& asteroids, peria::Vertex_Batch& batch, float dt)
+{
+    asteroids.update(dt);
+    batch.clear();
+    for (const auto& a:asteroids) batch.add(a.get_model(), a.get_transform());
+    batch.expand();
+    for (std::size_t i{}; i<asteroids.size(); ++i) asteroids.update_collider(i, batch.vertices(i));
+}
+
+void bench_sat_simd()
+{
+    constexpr std::size_t PAIRS = 4096;
+    constexpr std::size_t REPEAT = 50;
+
+    const auto model_pieces = all_model_pieces();
+    auto random_model_piece = [&]() -> const peria::Polygon& {
+        return model_pieces[std::uniform_int_distribution<std::size_t>{0, model_pieces.size()-1}(bench_rng)];
+    };
+
+    std::vector<std::pair<peria::Small_Polygon, peria::Small_Polygon>> pairs;
+    std::vector<std::pair<peria::Soa_Polygon, peria::Soa_Polygon>> soa_pairs;
+    pairs.reserve(PAIRS);
+    soa_pairs.reserve(PAIRS);
+    for (std::size_t i{}; i<PAIRS; ++i) {
+        pairs.emplace_back(random_world_piece(random_model_piece()), random_world_piece(random_model_piece()));
+        soa_pairs.emplace_back(peria::Soa_Polygon{pairs.back().first}, peria::Soa_Polygon{pairs.back().second});
+    }
+
+    std::size_t hits_scalar{};
+    std::size_t hits_simd{};
+    std::size_t mismatches{};
+    for (std::size_t i{}; i<PAIRS; ++i) {
+        const auto a = peria::sat(pairs[i].first, pairs[i].second);
+        const auto b = peria::sat_simd(soa_pairs[i].first, soa_pairs[i].second);
+        mismatches += (a != b);
+    }
+
+    const auto scalar_ns = measure_ns(REPEAT, [&]() {
+        for (const auto& [a, b]:pairs) hits_scalar += peria::sat(a, b);
+    }) / PAIRS;
+    const auto simd_ns = measure_ns(REPEAT, [&]() {
+        for (const auto& [a, b]:soa_pairs) hits_simd += peria::sat_simd(a, b);
+    }) / PAIRS;
+
+    std::cout << "sat vs sat_simd (" << peria::sat_simd_kernel_name() << ") on " << model_pieces.size() << " asteroid model pieces\n"
+              << "  pairs: " << PAIRS << ", colliding: " << hits_scalar/REPEAT << ", mismatches: " << mismatches << '\n'
+              << "  sat:      " << scalar_ns << " ns/pair\n"
+              << "  sat_simd: " << simd_ns << " ns/pair\n";
+    if (hits_scalar != hits_simd) std::cout << "  WARNING: hit counts differ\n";
+}
+
+// Runs same collision steps as Game::update_playing_state on a synthetic field
+// and counts heap allocations once the field reached steady state.
+void bench_collision_allocations()
+{
+    constexpr std::size_t ASTEROIDS = 64;
+    constexpr std::size_t BULLETS = 512;
+    constexpr std::size_t TICKS = 60;
+    constexpr float DT = 1.0f/60.0f;
+
+    const auto [w, h] = Game::get_world_size();
+    auto random_dir = []() {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        return glm::vec2{std::cos(angle), std::sin(angle)};
+    };
+
+    Asteroid_Pool asteroids;
+    asteroids.reserve(ASTEROIDS);
+    for (std::size_t i{}; i<ASTEROIDS; ++i) {
+        const auto type = static_cast<Asteroid::Asteroid_Type>(i%3);
+        asteroids.spawn(type, glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)}, random_dir(), 5);
+    }
+    Bullet_Pool bullets{BULLETS};
+    for (std::size_t i{}; i<BULLETS; ++i) {
+        bullets.spawn(glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)}, random_dir(), Bullet_Type::GUN);
+    }
+
+    peria::Sat_Cache cache;
+    peria::Aabb_Tree tree;
+    for (uint32_t i{}; i<asteroids.size(); ++i) asteroids[i].set_broadphase_proxy(tree.insert(asteroids[i].get_bounds().aabb, i));
+    std::vector<uint32_t> candidates;
+    candidates.reserve(ASTEROIDS);
+    peria::Narrowphase_Stats stats;
+    std::size_t hits{};
+    peria::Vertex_Batch batch;
+
+    auto tick = [&]() {
+        update_asteroids(asteroids, batch, DT);
+        bullets.update(DT);
+
+        for (const auto& a:asteroids) tree.move(a.get_broadphase_proxy(), a.get_bounds().aabb);
+
+        for (std::size_t i{}; i<bullets.size(); ++i) {
+            const auto b = bullets[i];
+            tree.query(b.get_bounds().aabb, candidates);
+            for (const auto ai:candidates) {
+                const auto& a = asteroids[ai];
+                hits += peria::narrowphase(b.get_bounds(), a.get_bounds(), stats, [&]() {
+                    return cache.sweep_concave_sat(a.get_id(), b.get_id(), b.get_prev_world_points(), peria::AXIS_ALIGNED_AXES, b.get_displacement(), a.get_convex_pieces_in_world()).has_value();
+                });
+            }
+        }
+    };
+
+    tick(); // first tick grows query buffer
+    const auto before = peria::heap_allocations();
+    const auto ns = measure_ns(TICKS, tick);
+    const auto allocations = peria::heap_allocations() - before;
+
+    std::cout << "collision tick, " << ASTEROIDS << " asteroids, " << BULLETS << " bullets\n"
+              << "  " << ns/1000.0 << " us/tick, narrowphase calls: " << stats.calls << ", hits: " << hits << '\n';
+#ifdef PERIA_DEBUG
+    std::cout << "  heap allocations in " << TICKS << " steady state ticks: " << allocations << '\n';
+#else
+    (void)allocations;
+    std::cout << "  heap allocations are only counted in debug builds\n";
+#endif
+}
+
+// Bullets bucketed into spatial grid every tick and queried with asteroid bounds,
+// same way Game used it before aabb tree. Boxes hang over world edges, grid must find
+// every pair that overlaps on toroidal world (no false negatives), brute force is the reference.
+void bench_spatial_grid()
+{
+    constexpr std::size_t ASTEROIDS = 64;
+    constexpr std::size_t BULLETS = 512;
+    constexpr std::size_t TICKS = 120;
+    constexpr float CELL_SIZE = 100.0f; // same as Game had
+
+    const auto [w, h] = Game::get_world_size();
+
+    struct Box {
+        peria::AABB_Collider aabb;
+        glm::vec2 velocity;
+    };
+    auto random_boxes = [&](std::size_t count, float min_size, float max_size, float min_speed, float max_speed) {
+        std::vector<Box> boxes(count);
+        for (auto& b:boxes) {
+            const auto size = rand_float(min_size, max_size);
+            const auto angle = rand_float(0.0f, 6.2831853f);
+            b.aabb = {{rand_float(0.0f, w), rand_float(0.0f, h)}, {size, size}};
+            b.velocity = glm::vec2{std::cos(angle), std::sin(angle)} * rand_float(min_speed, max_speed);
+        }
+        return boxes;
+    };
+    auto asteroids = random_boxes(ASTEROIDS, 40.0f, 150.0f, 30.0f, 150.0f);
+    auto bullets = random_boxes(BULLETS, 8.0f, 16.0f, 400.0f, 800.0f);
+
+    // top left corner stays in world, rest of box can hang over right and bottom edge
+    auto move = [&](std::vector<Box>& boxes) {
+        for (auto& b:boxes) {
+            b.aabb.pos += b.velocity * (1.0f/60.0f);
+            if (b.aabb.pos.x < 0.0f) b.aabb.pos.x += w;
+            else if (b.aabb.pos.x > w) b.aabb.pos.x -= w;
+            if (b.aabb.pos.y < 0.0f) b.aabb.pos.y += h;
+            else if (b.aabb.pos.y > h) b.aabb.pos.y -= h;
+        }
+    };
+    auto toroidal_overlap = [&](const peria::AABB_Collider& a, peria::AABB_Collider b) {
+        const auto pos = b.pos;
+        for (const auto dx:{-w, 0.0f, w}) {
+            for (const auto dy:{-h, 0.0f, h}) {
+                b.pos = pos + glm::vec2{dx, dy};
+                if (peria::aabb(a, b)) return true;
+            }
+        }
+        return false;
+    };
+
+    peria::Spatial_Grid grid{{w, h}, CELL_SIZE};
+    std::vector<uint32_t> candidates;
+    candidates.reserve(BULLETS);
+    peria::Broadphase_Stats stats;
+    std::size_t misses{};
+    std::size_t overlaps{};
+
+    const auto grid_ns = measure_ns(TICKS, [&]() {
+        move(asteroids);
+        move(bullets);
+        grid.clear();
+        for (uint32_t i{}; i<BULLETS; ++i) grid.insert(i, bullets[i].aabb);
+        for (const auto& a:asteroids) {
+            grid.query(a.aabb, candidates);
+            stats.pairs_tested += candidates.size();
+            stats.pairs_culled += grid.size() - candidates.size();
+        }
+    });
+
+    std::size_t brute_sink{};
+    const auto brute_ns = measure_ns(TICKS, [&]() {
+        move(asteroids);
+        move(bullets);
+        for (const auto& a:asteroids) {
+            for (const auto& b:bullets) brute_sink += toroidal_overlap(a.aabb, b.aabb);
+        }
+    });
+
+    // no false negatives, checked at final positions
+    grid.clear();
+    for (uint32_t i{}; i<BULLETS; ++i) grid.insert(i, bullets[i].aabb);
+    for (const auto& a:asteroids) {
+        grid.query(a.aabb, candidates);
+        for (uint32_t i{}; i<BULLETS; ++i) {
+            if (!toroidal_overlap(a.aabb, bullets[i].aabb)) continue;
+            ++overlaps;
+            misses += !std::binary_search(candidates.begin(), candidates.end(), i);
+        }
+    }
+
+    const auto pairs = static_cast<double>(stats.pairs_tested + stats.pairs_culled);
+    std::cout << "spatial grid, " << ASTEROIDS << " asteroids, " << BULLETS << " bullets, " << TICKS << " ticks\n"
+              << "  grid:        " << grid_ns/1000.0 << " us/tick, pairs tested: " << stats.pairs_tested/TICKS
+              << "/tick, culled: " << 100.0*stats.pairs_culled/pairs << "%\n"
+              << "  brute force: " << brute_ns/1000.0 << " us/tick (" << brute_sink/TICKS << " overlaps/tick)\n"
+              << "  overlapping pairs: " << overlaps << ", missed by grid: " << misses << '\n';
+}
+
+// Sweep and prune against brute force all pairs aabb test, on boxes moving like asteroids.
+// World grows with entity count, so density stays the same as in game.
+void bench_sweep_and_prune()
+{
+    struct Box {
+        peria::AABB_Collider aabb;
+        glm::vec2 velocity;
+    };
+
+    std::cout << "sweep and prune vs brute force, all overlapping pairs\n";
+    for (const std::size_t count:{10u, 1'000u, 50'000u}) {
+        const auto [game_w, game_h] = Game::get_world_size();
+        const auto world_scale = std::sqrt(static_cast<float>(count) / 64.0f);
+        const auto w = game_w * world_scale;
+        const auto h = game_h * world_scale;
+
+        std::vector<Box> boxes(count);
+        for (auto& b:boxes) {
+            const auto size = rand_float(20.0f, 150.0f);
+            const auto angle = rand_float(0.0f, 6.2831853f);
+            b.aabb = {{rand_float(0.0f, w), rand_float(0.0f, h)}, {size, size}};
+            b.velocity = glm::vec2{std::cos(angle), std::sin(angle)} * rand_float(30.0f, 150.0f);
+        }
+
+        auto move = [&]() {
+            for (auto& b:boxes) {
+                b.aabb.pos += b.velocity * (1.0f/60.0f);
+                if (b.aabb.pos.x < 0.0f) b.aabb.pos.x += w;
+                else if (b.aabb.pos.x > w) b.aabb.pos.x -= w;
+                if (b.aabb.pos.y < 0.0f) b.aabb.pos.y += h;
+                else if (b.aabb.pos.y > h) b.aabb.pos.y -= h;
+            }
+        };
+
+        peria::Sweep_And_Prune sap;
+        std::vector<peria::Sweep_And_Prune::Proxy> proxies;
+        for (uint32_t i{}; i<count; ++i) proxies.push_back(sap.insert(boxes[i].aabb, i));
+        sap.sort(); // first sort is from random order
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        pairs.reserve(count*4);
+
+        std::size_t swaps{};
+        std::size_t sap_pairs{};
+        // keep total work per size roughly same
+        const auto ticks = std::max<std::size_t>(3, 100'000 / count);
+        const auto sap_ns = measure_ns(ticks, [&]() {
+            move();
+            for (uint32_t i{}; i<count; ++i) sap.update(proxies[i], boxes[i].aabb, i);
+            sap.sort();
+            sap.find_pairs(pairs);
+            swaps += sap.last_sort_swaps();
+            sap_pairs = pairs.size();
+        });
+
+        std::size_t brute_pairs{};
+        const auto brute_ticks = std::max<std::size_t>(1, 10'000'000 / (count*count));
+        const auto brute_ns = measure_ns(brute_ticks, [&]() {
+            move();
+            brute_pairs = 0;
+            for (std::size_t i{}; i<count; ++i) {
+                for (auto j=i+1; j<count; ++j) {
+                    brute_pairs += peria::aabb(boxes[i].aabb, boxes[j].aabb);
+                }
+            }
+        });
+
+        // both found same pairs for the final positions
+        for (uint32_t i{}; i<count; ++i) sap.update(proxies[i], boxes[i].aabb, i);
+        sap.sort();
+        sap.find_pairs(pairs);
+        sap_pairs = pairs.size();
+
+        std::cout << "  " << count << " entities, pairs: " << brute_pairs
+                  << (sap_pairs == brute_pairs ? "" : " MISMATCH sap: " + std::to_string(sap_pairs)) << '\n'
+                  << "    brute force:     " << brute_ns/1000.0 << " us/tick\n"
+                  << "    sweep and prune: " << sap_ns/1000.0 << " us/tick, " << swaps/ticks << " swaps/tick\n";
+    }
+}
+
+// Dynamic aabb tree on boxes moving like asteroids: how often leaves need reinsert,
+// query cost against brute force, and ray cast / nearest checked against brute force.
+void bench_aabb_tree()
+{
+    constexpr std::size_t COUNT = 1'000;
+    constexpr std::size_t TICKS = 120;
+    constexpr std::size_t QUERIES = 1'000;
+
+    const auto [game_w, game_h] = Game::get_world_size();
+    const auto world_scale = std::sqrt(static_cast<float>(COUNT) / 64.0f);
+    const auto w = game_w * world_scale;
+    const auto h = game_h * world_scale;
+
+    struct Box {
+        peria::AABB_Collider aabb;
+        glm::vec2 velocity;
+        peria::Aabb_Tree::Proxy proxy;
+    };
+
+    peria::Aabb_Tree tree;
+    std::vector<Box> boxes(COUNT);
+    for (uint32_t i{}; i<COUNT; ++i) {
+        auto& b = boxes[i];
+        const auto size = rand_float(20.0f, 150.0f);
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        b.aabb = {{rand_float(0.0f, w), rand_float(0.0f, h)}, {size, size}};
+        b.velocity = glm::vec2{std::cos(angle), std::sin(angle)} * rand_float(30.0f, 150.0f);
+        b.proxy = tree.insert(b.aabb, i);
+    }
+
+    std::size_t reinserts{};
+    const auto move_ns = measure_ns(TICKS, [&]() {
+        for (auto& b:boxes) {
+            b.aabb.pos += b.velocity * (1.0f/60.0f);
+            reinserts += tree.move(b.proxy, b.aabb);
+        }
+    });
+
+    std::vector<peria::AABB_Collider> queries(QUERIES);
+    for (auto& q:queries) q = {{rand_float(0.0f, w), rand_float(0.0f, h)}, {10.0f, 10.0f}};
+
+    std::vector<uint32_t> out;
+    std::size_t tree_found{};
+    std::size_t brute_found{};
+    const auto tree_ns = measure_ns(1, [&]() {
+        for (const auto& q:queries) {
+            tree.query(q, out);
+            // fat bounds give false positives, count only real overlaps
+            for (const auto i:out) tree_found += peria::aabb(q, boxes[i].aabb);
+        }
+    }) / QUERIES;
+    const auto brute_ns = measure_ns(1, [&]() {
+        for (const auto& q:queries) {
+            for (const auto& b:boxes) brute_found += peria::aabb(q, b.aabb);
+        }
+    }) / QUERIES;
+
+    // exact tests on boxes themselves
+    auto center = [&](uint32_t i) { return boxes[i].aabb.pos + glm::vec2{boxes[i].aabb.size.x, -boxes[i].aabb.size.y}*0.5f; };
+    auto distance_to_center = [&](glm::vec2 p) {
+        return [&, p](uint32_t i) { return glm::length(center(i) - p); };
+    };
+    // segment against box, same slab test as tree but on exact bounds
+    auto segment_box = [&](uint32_t i, glm::vec2 from, glm::vec2 to) -> std::optional<float> {
+        const auto& a = boxes[i].aabb;
+        const glm::vec2 mn{a.pos.x, a.pos.y-a.size.y};
+        const glm::vec2 mx{a.pos.x+a.size.x, a.pos.y};
+        const auto dir = to - from;
+        auto t_min = 0.0f;
+        auto t_max = 1.0f;
+        for (int k{}; k<2; ++k) {
+            if (std::abs(dir[k]) < 1e-9f) {
+                if (from[k] < mn[k] || from[k] > mx[k]) return std::nullopt;
+                continue;
+            }
+            auto t1 = (mn[k] - from[k]) / dir[k];
+            auto t2 = (mx[k] - from[k]) / dir[k];
+            if (t1 > t2) std::swap(t1, t2);
+            t_min = std::max(t_min, t1);
+            t_max = std::min(t_max, t2);
+            if (t_min > t_max) return std::nullopt;
+        }
+        return t_min;
+    };
+
+    std::size_t nearest_mismatches{};
+    std::size_t ray_mismatches{};
+    for (std::size_t q{}; q<QUERIES; ++q) {
+        const glm::vec2 p{rand_float(0.0f, w), rand_float(0.0f, h)};
+
+        const auto hit = tree.nearest(p, distance_to_center(p));
+        auto best = std::numeric_limits<float>::max();
+        for (uint32_t i{}; i<COUNT; ++i) best = std::min(best, distance_to_center(p)(i));
+        nearest_mismatches += !hit || hit->distance != best;
+
+        const glm::vec2 to = p + glm::vec2{rand_float(-500.0f, 500.0f), rand_float(-500.0f, 500.0f)};
+        const auto ray = tree.ray_cast(p, to, segment_box);
+        std::optional<float> closest;
+        for (uint32_t i{}; i<COUNT; ++i) {
+            const auto t = segment_box(i, p, to);
+            if (t && (!closest || *t < *closest)) closest = t;
+        }
+        ray_mismatches += ray.has_value() != closest.has_value() ||
+                          (ray && std::abs(ray->fraction - *closest) > 1e-4f);
+    }
+
+    std::cout << "aabb tree, " << COUNT << " moving boxes, height: " << tree.height() << '\n'
+              << "  reinserted leaves: " << static_cast<double>(reinserts)/(TICKS*COUNT)*100.0 << "% per tick, "
+              << move_ns/1000.0 << " us/tick\n"
+              << "  box query: " << tree_ns << " ns, brute force: " << brute_ns << " ns"
+              << (tree_found == brute_found ? "" : ", MISMATCH") << '\n'
+              << "  nearest mismatches: " << nearest_mismatches << ", ray cast mismatches: " << ray_mismatches << '\n';
+}
+
+// Separating axis cache on bullet/asteroid field: how often cached axis settles the test,
+// and that results match uncached sweep_concave_sat.
+void bench_sat_cache()
+{
+    constexpr std::size_t ASTEROIDS = 64;
+    constexpr std::size_t BULLETS = 512;
+    constexpr std::size_t TICKS = 120;
+    constexpr float DT = 1.0f/60.0f;
+
+    const auto [w, h] = Game::get_world_size();
+    auto random_dir = []() {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        return glm::vec2{std::cos(angle), std::sin(angle)};
+    };
+
+    Asteroid_Pool asteroids;
+    for (std::size_t i{}; i<ASTEROIDS; ++i) {
+        asteroids.spawn(static_cast<Asteroid::Asteroid_Type>(i%3), glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)}, random_dir(), 5);
+    }
+    Bullet_Pool bullets;
+    for (std::size_t i{}; i<BULLETS; ++i) {
+        bullets.spawn(glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)}, random_dir(), Bullet_Type::GUN);
+    }
+
+    peria::Sat_Cache cache;
+    peria::Sat_Cache_Stats total;
+    std::size_t tests{};
+    std::size_t mismatches{};
+    double cached_ns{};
+    double full_ns{};
+    peria::Vertex_Batch batch;
+
+    for (std::size_t t{}; t<TICKS; ++t) {
+        update_asteroids(asteroids, batch, DT);
+        bullets.update(DT);
+
+        // only pairs that pass bounds tests reach SAT in game
+        std::vector<std::pair<std::size_t, std::size_t>> pairs;
+        for (std::size_t ai{}; ai<asteroids.size(); ++ai) {
+            for (std::size_t i{}; i<bullets.size(); ++i) {
+                if (peria::aabb(asteroids[ai].get_bounds().aabb, bullets[i].get_bounds().aabb)) pairs.emplace_back(ai, i);
+            }
+        }
+        tests += pairs.size();
+
+        std::size_t cached_hits{};
+        std::size_t full_hits{};
+        std::vector<char> hit(pairs.size());
+        cache.reset_stats();
+        cached_ns += measure_ns(1, [&]() {
+            for (const auto& [ai, bi]:pairs) {
+                const auto a = asteroids[ai];
+                const auto b = bullets[bi];
+                cached_hits += cache.sweep_concave_sat(a.get_id(), b.get_id(), b.get_prev_world_points(), peria::AXIS_ALIGNED_AXES, b.get_displacement(), a.get_convex_pieces_in_world()).has_value();
+            }
+        });
+        full_ns += measure_ns(1, [&]() {
+            for (std::size_t i{}; i<pairs.size(); ++i) {
+                const auto [ai, bi] = pairs[i];
+                const auto b = bullets[bi];
+                hit[i] = peria::sweep_concave_sat(b.get_prev_world_points(), peria::AXIS_ALIGNED_AXES, b.get_displacement(), asteroids[ai].get_convex_pieces_in_world()).has_value();
+                full_hits += hit[i];
+            }
+        });
+        mismatches += cached_hits != full_hits;
+
+        // like in game, bullet dies on hit and player keeps shooting
+        for (std::size_t i{}; i<pairs.size(); ++i) {
+            if (hit[i]) bullets.explode(pairs[i].second);
+        }
+        std::pmr::vector<uint32_t> dead_ids;
+        bullets.remove_dead(dead_ids);
+        for (std::size_t i{}; i<dead_ids.size(); ++i) {
+            bullets.spawn(glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)}, random_dir(), Bullet_Type::GUN);
+        }
+        std::sort(dead_ids.begin(), dead_ids.end());
+        cache.evict(dead_ids);
+
+        total.hits += cache.stats().hits;
+        total.stale += cache.stats().stale;
+        total.misses += cache.stats().misses;
+    }
+
+    std::cout << "sat cache, " << ASTEROIDS << " asteroids, " << BULLETS << " bullets, " << TICKS << " ticks\n"
+              << "  sat tests: " << tests << ", cached axis hits: " << total.hits << " ("
+              << (tests ? static_cast<double>(total.hits)/tests*100.0 : 0.0) << "%), stale: " << total.stale
+              << ", misses: " << total.misses << ", tick mismatches: " << mismatches << '\n'
+              << "  cached: " << (tests ? cached_ns/tests : 0.0) << " ns/test, full: " << (tests ? full_ns/tests : 0.0) << " ns/test\n";
+}
+
+// Precomputed model space axes against edge normals built on every sat call,
+// on random pairs of asteroids and on bullets against asteroids.
+void bench_model_axes()
+{
+    constexpr std::size_t PAIRS = 4096;
+    constexpr std::size_t REPEAT = 20;
+
+    std::size_t edges{};
+    std::size_t axes{};
+    for (auto t:{Asteroid::Asteroid_Type::SMALL, Asteroid::Asteroid_Type::MEDIUM, Asteroid::Asteroid_Type::LARGE}) {
+        for (std::size_t i{}; i<Asteroid::get_models(t).size(); ++i) {
+            const auto& model = Asteroid::get_convex_pieces(t, i);
+            for (std::size_t p{}; p<model.pieces.size(); ++p) {
+                edges += model.pieces[p].points().size();
+                axes += model.axes[p].size();
+            }
+        }
+    }
+
+    Asteroid_Pool random_asteroids;
+    auto random_asteroid = [&]() {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        // small area, so some of the pairs collide
+        return random_asteroids[random_asteroids.spawn(static_cast<Asteroid::Asteroid_Type>(std::uniform_int_distribution<int>{0, 2}(bench_rng)),
+                                                       glm::vec2{rand_float(0.0f, 300.0f), rand_float(0.0f, 300.0f)}, glm::vec2{std::cos(angle), std::sin(angle)}, 1)];
+    };
+
+    std::vector<std::pair<std::vector<peria::Small_Polygon>, std::vector<peria::Small_Polygon>>> with_axes;
+    for (std::size_t i{}; i<PAIRS; ++i) {
+        const auto a = random_asteroid();
+        const auto b = random_asteroid();
+        const auto a_pieces = a.get_convex_pieces_in_world();
+        const auto b_pieces = b.get_convex_pieces_in_world();
+        with_axes.emplace_back(std::vector<peria::Small_Polygon>{a_pieces.begin(), a_pieces.end()},
+                               std::vector<peria::Small_Polygon>{b_pieces.begin(), b_pieces.end()});
+    }
+    // same pieces, axes dropped so sat builds them from edges
+    auto without_axes = with_axes;
+    for (auto& [a, b]:without_axes) {
+        for (auto& p:a) p.resize_axes(0);
+        for (auto& p:b) p.resize_axes(0);
+    }
+
+    std::size_t mismatches{};
+    for (std::size_t i{}; i<PAIRS; ++i) {
+        mismatches += peria::concave_sat(with_axes[i].first, with_axes[i].second) !=
+                      peria::concave_sat(without_axes[i].first, without_axes[i].second);
+    }
+
+    std::size_t hits_axes{};
+    std::size_t hits_edges{};
+    const auto axes_ns = measure_ns(REPEAT, [&]() {
+        for (const auto& [a, b]:with_axes) hits_axes += peria::concave_sat(a, b);
+    }) / PAIRS;
+    const auto edges_ns = measure_ns(REPEAT, [&]() {
+        for (const auto& [a, b]:without_axes) hits_edges += peria::concave_sat(a, b);
+    }) / PAIRS;
+
+    std::cout << "model space axes, asteroid models: " << edges << " edges, " << axes << " unique axes\n"
+              << "  asteroid pairs: " << PAIRS << ", colliding: " << hits_axes/REPEAT << ", mismatches: " << mismatches << '\n'
+              << "  precomputed axes: " << axes_ns << " ns/pair\n"
+              << "  edge normals:     " << edges_ns << " ns/pair\n";
+    if (hits_axes != hits_edges) std::cout << "  WARNING: hit counts differ\n";
+}
+
+
+// Bullet/asteroid narrowphase of crowded field spread over job system with 1..16 threads.
+// Pairs come from aabb tree like in game, results must match single threaded run.
+void bench_parallel_narrowphase()
+{
+    constexpr std::size_t ASTEROIDS = 2000;
+    constexpr std::size_t BULLETS = 8000;
+    constexpr std::size_t REPEAT = 10;
+    constexpr std::size_t CHUNK = 64;
+
+    // bigger world than game, so the field is crowded but not overlapping everywhere
+    const auto [gw, gh] = Game::get_world_size();
+    const auto w = gw*4.0f;
+    const auto h = gh*4.0f;
+    auto random_dir = []() {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        return glm::vec2{std::cos(angle), std::sin(angle)};
+    };
+
+    Asteroid_Pool asteroids;
+    asteroids.reserve(ASTEROIDS);
+    peria::Aabb_Tree tree;
+    for (uint32_t i{}; i<ASTEROIDS; ++i) {
+        asteroids.spawn(static_cast<Asteroid::Asteroid_Type>(i%3), glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)}, random_dir(), 5);
+        (void)tree.insert(asteroids[asteroids.size()-1].get_bounds().aabb, i);
+    }
+    Bullet_Pool bullets{BULLETS};
+    for (std::size_t i{}; i<BULLETS; ++i) {
+        bullets.spawn(glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)}, random_dir(), Bullet_Type::GUN);
+    }
+    bullets.update(1.0f/60.0f); // gives bullets displacement to sweep
+
+    struct Pair {
+        uint32_t bullet;
+        uint32_t asteroid;
+    };
+    std::vector<Pair> pairs;
+    std::vector<uint32_t> candidates;
+    for (uint32_t i{}; i<BULLETS; ++i) {
+        tree.query(bullets[i].get_bounds().aabb, candidates);
+        for (const auto a:candidates) pairs.push_back({i, a});
+    }
+
+    // filled cache so part of the pairs take the cached axis path like in game
+    peria::Sat_Cache cache{1 << 16};
+    for (const auto& p:pairs) {
+        const auto& a = asteroids[p.asteroid];
+        const auto& b = bullets[p.bullet];
+        (void)cache.sweep_concave_sat(a.get_id(), b.get_id(), b.get_prev_world_points(), peria::AXIS_ALIGNED_AXES, b.get_displacement(), a.get_convex_pieces_in_world());
+    }
+
+    auto run = [&](peria::Job_System& jobs, std::vector<std::optional<float>>& out) {
+        jobs.parallel_for(pairs.size(), CHUNK, [&](std::size_t begin, std::size_t end, std::size_t) {
+            for (auto i=begin; i<end; ++i) {
+                const auto& a = asteroids[pairs[i].asteroid];
+                const auto& b = bullets[pairs[i].bullet];
+                out[i] = cache.sweep_test(a.get_id(), b.get_id(), b.get_prev_world_points(), peria::AXIS_ALIGNED_AXES, b.get_displacement(), a.get_convex_pieces_in_world()).toi;
+            }
+        });
+    };
+
+    std::vector<std::optional<float>> serial(pairs.size());
+    std::vector<std::optional<float>> parallel(pairs.size());
+    {
+        peria::Job_System jobs{0};
+        run(jobs, serial);
+    }
+    const auto hits = std::count_if(serial.begin(), serial.end(), [](const auto& t) { return t.has_value(); });
+
+    std::cout << "parallel narrowphase, " << ASTEROIDS << " asteroids, " << BULLETS << " bullets, "
+              << pairs.size() << " pairs, " << hits << " hits, hardware threads: " << std::thread::hardware_concurrency() << '\n';
+
+    double single_ns{};
+    for (std::size_t threads:{1, 2, 4, 8, 16}) {
+        peria::Job_System jobs{threads-1};
+        run(jobs, parallel); // warm up, wakes workers and grows queues
+        const auto ns = measure_ns(REPEAT, [&]() { run(jobs, parallel); });
+        if (threads == 1) single_ns = ns;
+        std::cout << "  " << threads << " threads: " << ns/1000.0 << " us/tick, speedup: " << single_ns/ns
+                  << (parallel == serial ? "" : ", MISMATCH") << '\n';
+    }
+}
+
+
+// Hertel-Mehlhorn convex_decompose against ear clipping triangulate(false), on asteroid models
+// and on random star shaped polygons with many vertices. Fewer pieces means fewer sat calls
+// in concave_sat, pieces must be convex and cover the polygon.
+void bench_convex_decomposition()
+{
+    auto area = [](peria::Polygon_View ps) {
+        float a{};
+        for (std::size_t i{}; i<ps.size(); ++i) a += ps[i].x*ps[(i+1)%ps.size()].y - ps[(i+1)%ps.size()].x*ps[i].y;
+        return std::abs(a) * 0.5f;
+    };
+    // pieces are convex and their areas add up to polygon area
+    auto valid = [&](peria::Polygon_View polygon, const std::vector<peria::Polygon>& pieces) {
+        float sum{};
+        for (const auto& p:pieces) {
+            if (!p.is_convex()) return false;
+            sum += area(p.points());
+        }
+        return std::abs(sum - area(polygon)) <= 1e-3f * area(polygon);
+    };
+
+    std::cout << "convex decomposition, asteroid models (pieces: ear clipping -> hertel-mehlhorn)\n";
+    std::vector<std::pair<std::vector<peria::Polygon>, std::vector<peria::Polygon>>> models;
+    std::size_t ear_total{};
+    std::size_t hm_total{};
+    for (auto t:{Asteroid::Asteroid_Type::SMALL, Asteroid::Asteroid_Type::MEDIUM, Asteroid::Asteroid_Type::LARGE}) {
+        for (const auto& model:Asteroid::get_models(t)) {
+            auto& [ear, hm] = models.emplace_back(peria::triangulate(model, false), peria::convex_decompose(model));
+            ear_total += ear.size();
+            hm_total += hm.size();
+            std::cout << "  " << model.size() << " vertices: " << ear.size() << " -> " << hm.size()
+                      << (valid(model, ear) ? "" : ", ear clipping INVALID") << (valid(model, hm) ? "" : ", hertel-mehlhorn INVALID") << '\n';
+        }
+    }
+    std::cout << "  total: " << ear_total << " -> " << hm_total << '\n';
+
+    // concave_sat on random asteroid pairs, it runs sat on every pair of pieces
+    constexpr std::size_t PAIRS = 4096;
+    constexpr std::size_t REPEAT = 20;
+    std::vector<std::array<std::vector<peria::Small_Polygon>, 4>> pairs(PAIRS); // ear a, ear b, hm a, hm b
+    for (auto& pair:pairs) {
+        for (std::size_t side{}; side<2; ++side) {
+            const auto& [ear, hm] = models[std::uniform_int_distribution<std::size_t>{0, models.size()-1}(bench_rng)];
+            const auto scale = rand_float(70.0f, 250.0f);
+            const Transform t{{rand_float(0.0f, 300.0f), rand_float(0.0f, 300.0f)}, {scale, scale}, rand_float(0.0f, 360.0f)};
+            peria::to_world(ear, t, pair[side]);
+            peria::to_world(hm, t, pair[2+side]);
+        }
+    }
+    std::size_t mismatches{};
+    for (const auto& p:pairs) mismatches += peria::concave_sat(p[0], p[1]) != peria::concave_sat(p[2], p[3]);
+    std::size_t hits{};
+    const auto ear_ns = measure_ns(REPEAT, [&]() {
+        for (const auto& p:pairs) hits += peria::concave_sat(p[0], p[1]);
+    }) / PAIRS;
+    const auto hm_ns = measure_ns(REPEAT, [&]() {
+        for (const auto& p:pairs) hits += peria::concave_sat(p[2], p[3]);
+    }) / PAIRS;
+    std::cout << "  concave_sat on " << PAIRS << " asteroid pairs, mismatches: " << mismatches << '\n'
+              << "    ear clipping:    " << ear_ns << " ns/pair\n"
+              << "    hertel-mehlhorn: " << hm_ns << " ns/pair\n";
+
+    // random star shaped polygons, clockwise like the models
+    std::cout << "  random polygons (pieces: ear clipping -> hertel-mehlhorn, decomposition time)\n";
+    for (std::size_t n:{100, 200, 400, 800}) {
+        constexpr std::size_t POLYGONS = 20;
+        std::size_t ear_pieces{};
+        std::size_t hm_pieces{};
+        std::size_t ear_invalid{};
+        std::size_t hm_invalid{};
+        double ear_us{};
+        double hm_us{};
+        for (std::size_t i{}; i<POLYGONS; ++i) {
+            std::vector<float> angles(n);
+            for (auto& a:angles) a = rand_float(0.0f, 6.2831853f);
+            std::sort(angles.begin(), angles.end(), std::greater{});
+            std::vector<glm::vec2> polygon;
+            for (const auto a:angles) polygon.push_back(rand_float(0.3f, 1.0f) * glm::vec2{std::cos(a), std::sin(a)});
+
+            std::vector<peria::Polygon> ear;
+            std::vector<peria::Polygon> hm;
+            ear_us += measure_ns(1, [&]() { ear = peria::triangulate(polygon, false); }) / 1000.0;
+            hm_us += measure_ns(1, [&]() { hm = peria::convex_decompose(polygon); }) / 1000.0;
+            ear_pieces += ear.size();
+            hm_pieces += hm.size();
+            ear_invalid += !valid(polygon, ear);
+            hm_invalid += !valid(polygon, hm);
+        }
+        std::cout << "    " << n << " vertices: " << static_cast<double>(ear_pieces)/POLYGONS << " -> "
+                  << static_cast<double>(hm_pieces)/POLYGONS << " pieces, "
+                  << ear_us/POLYGONS << " us -> " << hm_us/POLYGONS << " us, invalid: "
+                  << ear_invalid << " -> " << hm_invalid << '\n';
+    }
+}
+
+
+// SAT against GJK for every pair of shape classes, on random placements where about half
+// of the pairs collide. Both must agree, the faster one belongs in Narrowphase_Policy.
+// EPA depth is checked by pushing colliding pieces apart along its normal.
+void bench_gjk()
+{
+    constexpr std::size_t PAIRS = 4096;
+    constexpr std::size_t REPEAT = 20;
+
+    using Pieces = std::vector<peria::Small_Polygon>;
+    auto random_transform = [](float scale_x, float scale_y) {
+        return Transform{{rand_float(0.0f, 150.0f), rand_float(0.0f, 150.0f)}, {scale_x, scale_y}, rand_float(0.0f, 360.0f)};
+    };
+    auto asteroid = [&]() {
+        const auto t = static_cast<Asteroid::Asteroid_Type>(std::uniform_int_distribution<int>{0, 2}(bench_rng));
+        const auto& model = Asteroid::get_convex_pieces(t, std::uniform_int_distribution<std::size_t>{0, Asteroid::get_models(t).size()-1}(bench_rng));
+        const auto scale = t == Asteroid::Asteroid_Type::SMALL ? 70.0f : t == Asteroid::Asteroid_Type::MEDIUM ? 180.0f : 250.0f;
+        Pieces res;
+        peria::to_world(model, random_transform(scale, scale), res);
+        return res;
+    };
+    auto ship = [&]() {
+        Pieces res;
+        peria::to_world(Ship::get_convex_model(), random_transform(25.0f, 20.0f), res);
+        return res;
+    };
+    // bullets and collectibles are axis aligned squares
+    auto square = [&](float side) {
+        const glm::vec2 pos{rand_float(0.0f, 150.0f), rand_float(0.0f, 150.0f)};
+        const std::array<glm::vec2, 4> points{{pos, {pos.x+side, pos.y}, {pos.x+side, pos.y-side}, {pos.x, pos.y-side}}};
+        Pieces res(1, peria::Small_Polygon{points});
+        res[0].resize_axes(2);
+        std::copy(peria::AXIS_ALIGNED_AXES.begin(), peria::AXIS_ALIGNED_AXES.end(), res[0].axes().begin());
+        return res;
+    };
+
+    const std::pair<const char*, std::function<std::pair<Pieces, Pieces>()>> classes[] = {
+        {"asteroid-asteroid  ", [&]() { return std::pair{asteroid(), asteroid()}; }},
+        {"ship-asteroid      ", [&]() { return std::pair{ship(), asteroid()}; }},
+        {"bullet-asteroid    ", [&]() { return std::pair{square(9.0f), asteroid()}; }},
+        {"collectible-ship   ", [&]() { return std::pair{square(10.0f), ship()}; }},
+    };
+
+    std::cout << "narrowphase sat vs gjk, " << PAIRS << " random pairs per class\n";
+    for (const auto& [name, make_pair]:classes) {
+        std::vector<std::pair<Pieces, Pieces>> pairs;
+        for (std::size_t i{}; i<PAIRS; ++i) {
+            // half of the pairs are pushed far apart, so early outs show too
+            auto pair = make_pair();
+            if (i%2) {
+                for (auto& p:pair.second) for (auto& v:p.points()) v.x += 200.0f;
+            }
+            pairs.push_back(std::move(pair));
+        }
+
+        std::size_t mismatches{};
+        std::size_t hits{};
+        std::size_t epa_pairs{};
+        std::size_t epa_failures{};
+        for (const auto& [a, b]:pairs) {
+            const auto sat_hit = peria::concave_sat(a, b);
+            mismatches += sat_hit != peria::concave_gjk(a, b);
+            hits += sat_hit;
+
+            // moving b by depth along normal must leave pieces just touching
+            for (const auto& pa:a) {
+                for (const auto& pb:b) {
+                    const auto pen = peria::gjk_epa(pa, pb);
+                    if (!pen) continue;
+                    ++epa_pairs;
+                    auto moved = [&](float distance) {
+                        auto res = pb;
+                        for (auto& v:res.points()) v += pen->normal*distance;
+                        res.resize_axes(0);
+                        return peria::sat(pa, {}, res, {});
+                    };
+                    epa_failures += moved(pen->depth + 0.01f) || (pen->depth > 0.01f && !moved(pen->depth - 0.01f));
+                }
+            }
+        }
+
+        std::size_t sat_hits{};
+        std::size_t gjk_hits{};
+        const auto sat_ns = measure_ns(REPEAT, [&]() {
+            for (const auto& [a, b]:pairs) sat_hits += peria::concave_sat(a, b);
+        }) / PAIRS;
+        const auto gjk_ns = measure_ns(REPEAT, [&]() {
+            for (const auto& [a, b]:pairs) gjk_hits += peria::concave_gjk(a, b);
+        }) / PAIRS;
+
+        std::cout << "  " << name << "hits: " << hits << ", mismatches: " << mismatches
+                  << ", sat: " << sat_ns << " ns, gjk: " << gjk_ns << " ns, faster: " << (sat_ns <= gjk_ns ? "SAT" : "GJK")
+                  << ", epa pairs: " << epa_pairs << ", epa failures: " << epa_failures << '\n';
+        if (sat_hits != gjk_hits) std::cout << "  WARNING: hit counts differ\n";
+    }
+}
+
+
+// Vertex_Batch against what entities did before: Transform::model() mat4 and a new vector
+// per entity, for physics (current transform) and drawing (interpolated) separately.
+void bench_vertex_batch()
+{
+    constexpr std::size_t ASTEROIDS = 10000;
+    constexpr std::size_t REPEAT = 20;
+
+    const auto [w, h] = Game::get_world_size();
+    Asteroid_Pool asteroids;
+    asteroids.reserve(ASTEROIDS);
+    for (std::size_t i{}; i<ASTEROIDS; ++i) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        asteroids.spawn(static_cast<Asteroid::Asteroid_Type>(i%3), glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)},
+                        glm::vec2{std::cos(angle), std::sin(angle)}, 5);
+        asteroids.update(rand_float(0.0f, 0.5f)); // random angles, earlier asteroids turn more
+    }
+
+    auto mat4_outline = [](const Asteroid& a) {
+        std::vector<glm::vec2> vec; vec.reserve(a.get_model().size());
+        const auto& t = a.get_transform();
+        const auto transform = Transform::model(t.pos, t.scale, t.angle);
+        for (const auto& p:a.get_model()) {
+            const glm::vec4 transformed = transform*glm::vec4{p.x, p.y, 0.0f, 1.0f};
+            vec.emplace_back(transformed.x, transformed.y);
+        }
+        return vec;
+    };
+
+    peria::Vertex_Batch batch;
+    auto expand = [&]() {
+        batch.clear();
+        for (const auto& a:asteroids) batch.add(a.get_model(), a.get_transform());
+        batch.expand();
+    };
+    expand();
+
+    float max_error{};
+    for (std::size_t i{}; i<asteroids.size(); ++i) {
+        const auto reference = mat4_outline(asteroids[i]);
+        const auto batched = batch.vertices(i);
+        for (std::size_t j{}; j<reference.size(); ++j) {
+            max_error = std::max(max_error, glm::length(reference[j] - batched[j]));
+        }
+    }
+
+    std::size_t sink{};
+    const auto mat4_ns = measure_ns(REPEAT, [&]() {
+        for (const auto& a:asteroids) sink += mat4_outline(a).size();
+    });
+    const auto batch_ns = measure_ns(REPEAT, [&]() {
+        expand();
+        sink += batch.vertices().size();
+    });
+
+    const auto before = peria::heap_allocations();
+    expand();
+    const auto allocations = peria::heap_allocations() - before;
+
+    std::cout << "vertex batch, " << ASTEROIDS << " asteroids, " << batch.vertices().size() << " vertices\n"
+              << "  mat4 per entity: " << mat4_ns/1000.0 << " us, batch: " << batch_ns/1000.0 << " us"
+              << ", max error: " << max_error << '\n';
+#ifdef PERIA_DEBUG
+    std::cout << "  heap allocations of warm batch: " << allocations << '\n';
+#else
+    (void)allocations;
+#endif
+    if (sink == 0) std::cout << '\n';
+}
+
+
+// Homing gun target queries on collider tree against linear scan over all asteroids,
+// with wrapped distances checked against brute force over every shift of the world.
+void bench_target_query()
+{
+    constexpr std::size_t ASTEROIDS = 2000;
+    constexpr std::size_t QUERIES = 1000;
+    constexpr std::size_t K = Homing_Gun::RADAR_TARGETS;
+    constexpr float CONE_COS = 0.866f; // same as Homing_Gun
+
+    // world grows with asteroid count, so density stays that of a busy level
+    const auto [game_w, game_h] = Game::get_world_size();
+    const auto world_scale = std::sqrt(static_cast<float>(ASTEROIDS) / 64.0f);
+    const auto w = game_w * world_scale;
+    const auto h = game_h * world_scale;
+    const glm::vec2 world{w, h};
+    Asteroid_Pool asteroids;
+    asteroids.reserve(ASTEROIDS);
+    peria::Aabb_Tree tree;
+    for (uint32_t i{}; i<ASTEROIDS; ++i) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        asteroids.spawn(static_cast<Asteroid::Asteroid_Type>(i%3), glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)},
+                        glm::vec2{std::cos(angle), std::sin(angle)}, 5);
+        (void)tree.insert(asteroids[asteroids.size()-1].get_bounds().aabb, i);
+    }
+    auto to_asteroid = [](uint32_t user) { return static_cast<int>(user); };
+
+    struct Query {
+        glm::vec2 pos;
+        glm::vec2 dir;
+    };
+    std::vector<Query> queries(QUERIES);
+    for (auto& q:queries) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        q = {{rand_float(0.0f, w), rand_float(0.0f, h)}, {std::cos(angle), std::sin(angle)}};
+    }
+
+    // brute force over every asteroid and every shift of query point
+    auto brute_distance = [&](glm::vec2 p, glm::vec2 dir, std::size_t i, bool cone) {
+        auto best = std::numeric_limits<float>::infinity();
+        for (const auto x:{-1.0f, 0.0f, 1.0f}) {
+            for (const auto y:{-1.0f, 0.0f, 1.0f}) {
+                const auto d = asteroids[i].get_world_pos() - (p + glm::vec2{x, y}*world);
+                const auto len = glm::length(d);
+                if (!cone || glm::dot(d, dir) >= len*CONE_COS) best = std::min(best, len);
+            }
+        }
+        return best;
+    };
+
+    Homing_Gun gun;
+    std::vector<float> brute(ASTEROIDS);
+    std::vector<peria::Aabb_Tree::Nearest_Hit> hits;
+    std::size_t nearest_mismatches{};
+    std::size_t k_mismatches{};
+    std::size_t search_mismatches{};
+    auto differ = [](float a, float b) { return std::abs(a - b) > 1e-3f; };
+    for (const auto& q:queries) {
+        auto distance = [&](uint32_t user, glm::vec2 from) { return glm::length(asteroids[user].get_world_pos() - from); };
+
+        for (std::size_t i{}; i<ASTEROIDS; ++i) brute[i] = brute_distance(q.pos, q.dir, i, false);
+        auto sorted = brute;
+        std::partial_sort(sorted.begin(), sorted.begin()+K, sorted.end());
+
+        const auto hit = tree.nearest_wrapped(q.pos, world, distance);
+        nearest_mismatches += !hit || differ(hit->distance, sorted[0]);
+
+        tree.k_nearest_wrapped(q.pos, world, K, distance, hits);
+        bool k_ok = hits.size() == K;
+        for (std::size_t i{}; k_ok && i<K; ++i) k_ok = !differ(hits[i].distance, sorted[i]);
+        k_mismatches += !k_ok;
+
+        // nearest in cone, nearest anywhere if cone is empty
+        auto cone_best = std::numeric_limits<float>::infinity();
+        for (std::size_t i{}; i<ASTEROIDS; ++i) cone_best = std::min(cone_best, brute_distance(q.pos, q.dir, i, true));
+        const auto target = gun.search(q.pos, q.dir, asteroids, tree, world, to_asteroid);
+        const auto expected = cone_best != std::numeric_limits<float>::infinity() ? cone_best : sorted[0];
+        search_mismatches += target < 0 || differ(brute_distance(q.pos, q.dir, target, cone_best != std::numeric_limits<float>::infinity()), expected);
+    }
+
+    // what Homing_Gun::search did before: linear scan over centers, no wrap
+    std::size_t sink{};
+    const auto linear_ns = measure_ns(1, [&]() {
+        for (const auto& q:queries) {
+            int best_index = -1;
+            auto best = std::numeric_limits<float>::max();
+            for (std::size_t i{}; i<ASTEROIDS; ++i) {
+                const auto d = asteroids[i].get_world_pos() - q.pos;
+                const auto d2 = d.x*d.x + d.y*d.y;
+                if (d2 < best) {
+                    best = d2;
+                    best_index = static_cast<int>(i);
+                }
+            }
+            sink += best_index;
+        }
+    }) / QUERIES;
+    const auto search_ns = measure_ns(1, [&]() {
+        for (const auto& q:queries) sink += gun.search(q.pos, q.dir, asteroids, tree, world, to_asteroid);
+    }) / QUERIES;
+    const auto radar_ns = measure_ns(1, [&]() {
+        for (const auto& q:queries) gun.update_radar(q.pos, asteroids, tree, world, to_asteroid);
+    }) / QUERIES;
+
+    std::cout << "target query, " << ASTEROIDS << " asteroids, k = " << K << '\n'
+              << "  linear nearest: " << linear_ns << " ns, tree search (cone, wrapped): " << search_ns
+              << " ns, radar k nearest (wrapped): " << radar_ns << " ns\n"
+              << "  mismatches nearest: " << nearest_mismatches << ", k nearest: " << k_mismatches
+              << ", cone search: " << search_mismatches << '\n';
+    if (sink == 0) std::cout << '\n';
+}
+
+// Ray casts against asteroid field on wrapping world, collider tree and cached pieces
+// against brute force over every asteroid, which also checks hits.
+void bench_ray_cast()
+{
+    constexpr std::size_t ASTEROIDS = 500;
+    constexpr std::size_t RAYS = 10'000;
+    constexpr std::size_t CHECKED_RAYS = 1'000; // brute force is slow, checked on first rays only
+    constexpr float LENGTH = 800.0f;
+
+    const auto [game_w, game_h] = Game::get_world_size();
+    const auto world_scale = std::sqrt(static_cast<float>(ASTEROIDS) / 64.0f);
+    const glm::vec2 world{game_w * world_scale, game_h * world_scale};
+
+    Asteroid_Pool asteroids;
+    asteroids.reserve(ASTEROIDS);
+    peria::Aabb_Tree tree;
+    for (uint32_t i{}; i<ASTEROIDS; ++i) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        asteroids.spawn(static_cast<Asteroid::Asteroid_Type>(i%3), glm::vec2{rand_float(0.0f, world.x), rand_float(0.0f, world.y)},
+                        glm::vec2{std::cos(angle), std::sin(angle)}, 5);
+        (void)tree.insert(asteroids[asteroids.size()-1].get_bounds().aabb, i);
+    }
+    auto pieces_of = [&](uint32_t user) -> std::span<const peria::Small_Polygon> { return asteroids[user].get_convex_pieces_in_world(); };
+    auto cast_asteroid = [&](uint32_t user, glm::vec2 from, glm::vec2 to) {
+        return peria::segment_cast(asteroids[user].get_bounds(), pieces_of(user), from, to);
+    };
+
+    struct Ray {
+        glm::vec2 origin;
+        glm::vec2 dir;
+    };
+    std::vector<Ray> rays(RAYS);
+    for (auto& r:rays) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        r = {{rand_float(0.0f, world.x), rand_float(0.0f, world.y)}, {std::cos(angle), std::sin(angle)}};
+    }
+
+    auto brute_cast = [&](const Ray& r) {
+        std::array<peria::Segment_Piece, peria::MAX_SEGMENT_PIECES> pieces;
+        const auto count = peria::wrap_segment(r.origin, r.origin + r.dir*LENGTH, world, pieces);
+        for (std::size_t i{}; i<count; ++i) {
+            std::optional<std::pair<float, uint32_t>> best;
+            for (uint32_t a{}; a<ASTEROIDS; ++a) {
+                const auto hit = peria::segment_cast(pieces_of(a), pieces[i].from, pieces[i].to);
+                if (hit && (!best || hit->fraction < best->first)) best = {hit->fraction, a};
+            }
+            if (best) return std::optional{std::pair{pieces[i].start + (pieces[i].end - pieces[i].start)*best->first, best->second}};
+        }
+        return std::optional<std::pair<float, uint32_t>>{};
+    };
+
+    std::size_t hits{};
+    std::size_t mismatches{};
+    for (std::size_t i{}; i<CHECKED_RAYS; ++i) {
+        const auto hit = peria::ray_cast_wrapped(tree, rays[i].origin, rays[i].dir, LENGTH, world, cast_asteroid);
+        const auto expected = brute_cast(rays[i]);
+        hits += hit.has_value();
+        // asteroids don't overlap much, but on equal fractions either one is fine
+        mismatches += hit.has_value() != expected.has_value() ||
+                      (hit && std::abs(hit->fraction - expected->first) > 1e-5f);
+    }
+
+    std::size_t sink{};
+    const auto tree_ns = measure_ns(1, [&]() {
+        for (const auto& r:rays) sink += peria::ray_cast_wrapped(tree, r.origin, r.dir, LENGTH, world, cast_asteroid).has_value();
+    });
+    const auto brute_ns = measure_ns(1, [&]() {
+        for (std::size_t i{}; i<CHECKED_RAYS; ++i) sink += brute_cast(rays[i]).has_value();
+    }) * (static_cast<double>(RAYS) / CHECKED_RAYS);
+
+    std::cout << "ray cast, " << ASTEROIDS << " asteroids, " << RAYS << " rays of length " << LENGTH << " per tick\n"
+              << "  tree: " << tree_ns/1000.0 << " us/tick, brute force: " << brute_ns/1000.0 << " us/tick\n"
+              << "  hits: " << hits << " of " << CHECKED_RAYS << " checked, mismatches: " << mismatches << '\n';
+    if (sink == 0) std::cout << '\n';
+}
+
+// Bullet_Pool against array of bullet structs laid out like old Bullet class, with bullets
+// dying on hits and leaving world and player refilling them every tick. Checks that both
+// end with same bullets and counts allocations of pool once it reached capacity.
+void bench_bullet_pool()
+{
+    constexpr std::size_t BULLETS = 20'000;
+    constexpr std::size_t TICKS = 300;
+    constexpr float DT = 1.0f/60.0f;
+    constexpr float SPEED = 500.0f;
+
+    const auto [w, h] = Game::get_world_size();
+    std::vector<std::pair<glm::vec2, glm::vec2>> spawns(BULLETS*4); // pos, dir
+    for (auto& [pos, dir]:spawns) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        pos = {rand_float(0.0f, w), rand_float(0.0f, h)};
+        dir = {std::cos(angle), std::sin(angle)};
+    }
+    // stands in for asteroid hits, about 1% of bullets every tick
+    auto hit = [](uint32_t seq, std::size_t tick) { return (seq*7 + tick) % 97 == 0; };
+
+    struct Aos_Bullet {
+        glm::vec2 pos;
+        glm::vec2 prev_pos;
+        float radius;
+        glm::vec2 dir;
+        glm::vec4 color;
+        bool dead;
+        peria::Bounds bounds;
+        uint32_t seq;
+    };
+    std::vector<Aos_Bullet> aos;
+    aos.reserve(BULLETS);
+    uint32_t aos_spawned{};
+    auto aos_tick = [&](std::size_t tick) {
+        for (auto& b:aos) {
+            b.prev_pos = b.pos;
+            b.pos += b.dir*SPEED*DT;
+            if (b.pos.x-b.radius > w || b.pos.x+b.radius < 0.0f || b.pos.y-b.radius > h || b.pos.y+b.radius < 0.0f) b.dead = true;
+            b.bounds = peria::swept_square_bounds(b.prev_pos, b.pos, b.radius);
+        }
+        for (auto& b:aos) {
+            if (hit(b.seq, tick)) b.dead = true;
+        }
+        aos.erase(std::remove_if(aos.begin(), aos.end(), [](const Aos_Bullet& b) { return b.dead; }), aos.end());
+        while (aos.size() < BULLETS) {
+            const auto [pos, dir] = spawns[aos_spawned % spawns.size()];
+            aos.push_back({pos, pos, Bullet_Pool::radius(Bullet_Type::GUN), dir, glm::vec4{1.0f}, false,
+                           peria::swept_square_bounds(pos, pos, Bullet_Pool::radius(Bullet_Type::GUN)), aos_spawned});
+            ++aos_spawned;
+        }
+    };
+
+    Bullet_Pool pool{BULLETS};
+    std::pmr::vector<uint32_t> dead_ids;
+    dead_ids.reserve(BULLETS);
+    const auto first_id = peria::new_entity_id() + 1;
+    uint32_t pool_spawned{};
+    auto pool_tick = [&](std::size_t tick) {
+        pool.update(DT);
+        for (std::size_t i{}; i<pool.size(); ++i) {
+            if (hit(pool[i].get_id() - first_id, tick)) pool.explode(i);
+        }
+        dead_ids.clear();
+        pool.remove_dead(dead_ids);
+        while (pool.size() < BULLETS) {
+            const auto [pos, dir] = spawns[pool_spawned % spawns.size()];
+            pool.spawn(pos, dir, Bullet_Type::GUN);
+            ++pool_spawned;
+        }
+    };
+
+    aos_tick(0);
+    pool_tick(0);
+    double aos_ns{};
+    double pool_ns{};
+    std::size_t allocations{};
+    for (std::size_t t=1; t<TICKS; ++t) {
+        aos_ns += measure_ns(1, [&]() { aos_tick(t); });
+        const auto before = peria::heap_allocations();
+        pool_ns += measure_ns(1, [&]() { pool_tick(t); });
+        allocations += peria::heap_allocations() - before;
+    }
+
+    // pool reorders bullets, compare them in spawn order.
+    // pool builds bounds in other order of operations, so they only match up to rounding
+    struct Entry {
+        uint32_t seq;
+        glm::vec2 pos;
+        peria::Bounds bounds;
+    };
+    std::vector<Entry> a;
+    std::vector<Entry> b;
+    for (const auto& x:aos) a.push_back({x.seq, x.pos, x.bounds});
+    for (std::size_t i{}; i<pool.size(); ++i) b.push_back({pool[i].get_id() - first_id, pool[i].get_world_pos(), pool[i].get_bounds()});
+    auto by_seq = [](const Entry& l, const Entry& r) { return l.seq < r.seq; };
+    std::sort(a.begin(), a.end(), by_seq);
+    std::sort(b.begin(), b.end(), by_seq);
+    auto near = [](glm::vec2 l, glm::vec2 r) { return glm::all(glm::lessThanEqual(glm::abs(l - r), glm::vec2{1e-3f})); };
+    std::size_t mismatches{a.size() != b.size()};
+    for (std::size_t i{}; i<std::min(a.size(), b.size()); ++i) {
+        mismatches += a[i].seq != b[i].seq || a[i].pos != b[i].pos ||
+                      !near(a[i].bounds.aabb.pos, b[i].bounds.aabb.pos) || !near(a[i].bounds.aabb.size, b[i].bounds.aabb.size) ||
+                      std::abs(a[i].bounds.radius - b[i].bounds.radius) > 1e-3f;
+    }
+
+    std::cout << "bullet pool, " << BULLETS << " bullets, " << TICKS << " ticks, " << pool_spawned << " spawned\n"
+              << "  array of structs: " << aos_ns/(TICKS-1)/1000.0 << " us/tick\n"
+              << "  pool:             " << pool_ns/(TICKS-1)/1000.0 << " us/tick, allocations: " << allocations << '\n'
+              << "  mismatches: " << mismatches << '\n';
+}
+
+// Cost of creating, splitting and copying asteroids, which now share their model data.
+// Allocations are only counted in debug builds.
+void bench_asteroid_models()
+{
+    constexpr std::size_t ASTEROIDS = 10'000;
+    constexpr std::size_t REPEAT = 20;
+
+    const auto [w, h] = Game::get_world_size();
+    Asteroid_Pool asteroids;
+    asteroids.reserve(ASTEROIDS*Asteroid::split_tree_size(Asteroid::Asteroid_Type::MEDIUM));
+    auto before = peria::heap_allocations();
+    const auto create_ns = measure_ns(1, [&]() {
+        for (std::size_t i{}; i<ASTEROIDS; ++i) {
+            const auto angle = rand_float(0.0f, 6.2831853f);
+            asteroids.spawn(Asteroid::Asteroid_Type::LARGE, glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)},
+                            glm::vec2{std::cos(angle), std::sin(angle)}, 5);
+        }
+    });
+    const auto create_allocations = peria::heap_allocations() - before;
+
+    std::size_t children{};
+    before = peria::heap_allocations();
+    const auto split_ns = measure_ns(1, [&]() {
+        for (std::size_t i{}; i<ASTEROIDS; ++i) children += asteroids.split(i);
+    });
+    const auto split_allocations = peria::heap_allocations() - before;
+
+    // pool growth moves every asteroid, copy is the upper bound
+    Asteroid_Pool copy;
+    before = peria::heap_allocations();
+    const auto copy_ns = measure_ns(REPEAT, [&]() { copy = asteroids; });
+    const auto copy_allocations = (peria::heap_allocations() - before) / REPEAT;
+
+    std::cout << "asteroid models, " << ASTEROIDS << " large asteroids, bytes per asteroid, hot: " << Asteroid_Pool::HOT_BYTES
+              << ", cold: " << Asteroid_Pool::COLD_BYTES << '\n'
+              << "  create: " << create_ns/ASTEROIDS << " ns/asteroid, allocations: " << create_allocations << '\n'
+              << "  split:  " << split_ns/ASTEROIDS << " ns/asteroid, " << children << " children, allocations: " << split_allocations << '\n'
+              << "  copy:   " << copy_ns/asteroids.size() << " ns/asteroid, allocations: " << copy_allocations << '\n';
+}
+
+// Temporaries of drawing asteroids on frame arena against default heap.
+// Triangles from arena overload are checked against Polygon version.
+// Allocations are only counted in debug builds.
+void bench_frame_arena()
+{
+    constexpr std::size_t ASTEROIDS = 2'000;
+
+    const auto [w, h] = Game::get_world_size();
+    Asteroid_Pool asteroids;
+    asteroids.reserve(ASTEROIDS);
+    for (std::size_t i{}; i<ASTEROIDS; ++i) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        asteroids.spawn(static_cast<Asteroid::Asteroid_Type>(i%3), glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)},
+                        glm::vec2{std::cos(angle), std::sin(angle)}, 5);
+    }
+    peria::Vertex_Batch batch;
+    for (const auto& a:asteroids) batch.add(a.get_model(), a.get_transform());
+    batch.expand();
+
+    peria::Frame_Arena arena{64*1024};
+    std::size_t mismatches{};
+    for (std::size_t i{}; i<ASTEROIDS; ++i) {
+        const auto polygons = peria::triangulate(batch.vertices(i), true);
+        arena.reset();
+        std::pmr::vector<peria::Triangle> triangles{arena.resource()};
+        peria::triangulate(batch.vertices(i), triangles);
+        mismatches += polygons.size() != triangles.size();
+        for (std::size_t t{}; t<std::min(polygons.size(), triangles.size()); ++t) {
+            mismatches += !std::equal(triangles[t].begin(), triangles[t].end(), polygons[t].points().begin());
+        }
+    }
+
+    std::size_t sink{};
+    auto before = peria::heap_allocations();
+    const auto heap_ns = measure_ns(1, [&]() {
+        for (std::size_t i{}; i<ASTEROIDS; ++i) sink += peria::triangulate(batch.vertices(i), true).size();
+    });
+    const auto heap_allocations = peria::heap_allocations() - before;
+    before = peria::heap_allocations();
+    const auto arena_ns = measure_ns(1, [&]() {
+        for (std::size_t i{}; i<ASTEROIDS; ++i) {
+            arena.reset(); // same as Graphics::draw_polygon
+            std::pmr::vector<peria::Triangle> triangles{arena.resource()};
+            peria::triangulate(batch.vertices(i), triangles);
+            sink += triangles.size();
+        }
+    });
+    const auto arena_allocations = peria::heap_allocations() - before;
+
+    std::cout << "frame arena, " << ASTEROIDS << " asteroid outlines\n"
+              << "  triangulate heap:  " << heap_ns/ASTEROIDS << " ns/outline, allocations: " << heap_allocations << '\n'
+              << "  triangulate arena: " << arena_ns/ASTEROIDS << " ns/outline, allocations: " << arena_allocations
+              << ", arena overflows: " << arena.overflows() << ", mismatches: " << mismatches << '\n';
+    if (sink == 0) std::cout << '\n';
+}
+
+// Chain reaction, every asteroid of level is destroyed at once each tick until none are left.
+// Children are built at end of reserved pool with pooled collider pieces, same as Game.
+// Allocations are only counted in debug builds.
+void bench_asteroid_split()
+{
+    constexpr std::size_t LARGE = 200;
+    constexpr std::size_t LEVELS = 10;
+    constexpr auto TREE = Asteroid::split_tree_size(Asteroid::Asteroid_Type::LARGE);
+
+    const auto [w, h] = Game::get_world_size();
+    std::vector<glm::vec2> starts(LARGE);
+    for (auto& p:starts) p = {rand_float(0.0f, w), rand_float(0.0f, h)};
+
+    // same as Game, see reset_state and reserve_split_trees. Arena is bigger, Game levels have at most 3 large asteroids
+    peria::Frame_Arena collider_arena{8*1024*1024};
+    std::pmr::unsynchronized_pool_resource collider_pool{collider_arena.resource()};
+    Asteroid_Pool asteroids{&collider_pool};
+    std::size_t splits{};
+    std::size_t allocations{};
+    const auto ns = measure_ns(LEVELS, [&]() {
+        asteroids.clear();
+        collider_pool.release();
+        collider_arena.reset();
+        for (const auto& p:starts) asteroids.spawn(Asteroid::Asteroid_Type::LARGE, p, glm::vec2{1.0f, 0.0f}, 5);
+        asteroids.reserve(LARGE*TREE);
+        const auto before = peria::heap_allocations();
+        while (!asteroids.empty()) {
+            const auto parents = asteroids.size();
+            for (std::size_t i{}; i<parents; ++i) {
+                splits += asteroids.split(i);
+                asteroids[i].explode();
+            }
+            asteroids.remove_dead([](const Asteroid&) {});
+        }
+        allocations = peria::heap_allocations() - before;
+    });
+
+    // every asteroid but the large ones is a child
+    const std::size_t mismatches = splits != LEVELS*LARGE*(TREE-1);
+
+    std::cout << "asteroid split, " << LARGE << " large asteroids destroyed at once, " << splits/LEVELS << " children per level\n"
+              << "  in place: " << ns/1000.0 << " us/level, allocations (last level): " << allocations
+              << ", arena overflows: " << collider_arena.overflows() << '\n'
+              << "  mismatches: " << mismatches << '\n';
+}
+
+// Asteroid state layout on 100k asteroids: one object per asteroid with everything in it
+// (layout of Asteroid before hot/cold split) against packed hot arrays of Asteroid_Pool.
+// Tick moves every asteroid, frame reads interpolated transform of every asteroid, same
+// as Game. Both have to end in the same state. No cache counters here, bytes each
+// layout streams per asteroid are printed instead.
+void bench_asteroid_layout()
+{
+    constexpr std::size_t ASTEROIDS = 100'000;
+    constexpr std::size_t TICKS = 120;
+    constexpr float DT = 1.0f/60.0f;
+    constexpr float ALPHA = 0.5f;
+
+    const auto [w, h] = Game::get_world_size();
+    Asteroid_Pool pool;
+    pool.reserve(ASTEROIDS);
+    for (std::size_t i{}; i<ASTEROIDS; ++i) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        pool.spawn(static_cast<Asteroid::Asteroid_Type>(i%3), glm::vec2{rand_float(0.0f, w), rand_float(0.0f, h)},
+                   glm::vec2{std::cos(angle), std::sin(angle)}, 5);
+    }
+
+    struct Object_Asteroid {
+        Asteroid::Asteroid_Type type;
+        Transform transform;
+        Transform prev_transform;
+        glm::vec2 velocity;
+        float angle_rotation_speed;
+        uint8_t hp;
+        uint8_t level_id;
+        bool dead;
+        glm::vec4 color;
+        Asteroid::Model_Id model_id;
+        std::pmr::vector<peria::Small_Polygon> world_pieces;
+        peria::Bounds bounds;
+        peria::Aabb_Tree::Proxy proxy;
+        peria::Handle handle;
+        uint32_t id;
+
+        void update(float dt)
+        {
+            prev_transform = transform;
+            transform.angle += angle_rotation_speed*dt;
+            Transform::clamp_angle(transform.angle);
+            transform.pos += velocity*dt;
+            color = {0.8f, 0.8f, 0.8f, 1.0f};
+        }
+
+        Transform interpolated(float alpha) const
+        {
+            auto t = peria::interpolate_state(prev_transform, transform, alpha);
+            t.angle = transform.angle;
+            return t;
+        }
+    };
+    std::vector<Object_Asteroid> objects;
+    objects.reserve(ASTEROIDS);
+    for (const auto& a:pool) {
+        const auto t = a.get_transform();
+        const auto pieces = a.get_convex_pieces_in_world();
+        objects.push_back({a.get_type(), t, t, a.get_velocity(), a.get_angular_speed(), a.hp(), 5, false, glm::vec4{1.0f},
+                           a.get_model_id(), std::pmr::vector<peria::Small_Polygon>(pieces.begin(), pieces.end()),
+                           a.get_bounds(), peria::Aabb_Tree::NONE, {}, a.get_id()});
+    }
+
+    glm::vec2 object_sink{};
+    const auto object_ns = measure_ns(TICKS, [&]() {
+        for (auto& o:objects) o.update(DT);
+        for (const auto& o:objects) object_sink += o.interpolated(ALPHA).pos;
+    });
+    glm::vec2 pool_sink{};
+    const auto pool_ns = measure_ns(TICKS, [&]() {
+        pool.update(DT);
+        for (const auto& a:pool) pool_sink += a.get_interpolated_transform(ALPHA).pos;
+    });
+
+    std::size_t mismatches = object_sink != pool_sink;
+    for (std::size_t i{}; i<ASTEROIDS; ++i) {
+        const auto t = pool[i].get_transform();
+        mismatches += objects[i].transform.pos != t.pos || objects[i].transform.angle != t.angle;
+    }
+
+    std::cout << "asteroid layout, " << ASTEROIDS << " asteroids, " << TICKS << " ticks\n"
+              << "  objects: " << object_ns/ASTEROIDS << " ns/asteroid per tick, " << sizeof(Object_Asteroid) << " bytes per asteroid\n"
+              << "  pool:    " << pool_ns/ASTEROIDS << " ns/asteroid per tick, " << Asteroid_Pool::HOT_BYTES << " hot bytes per asteroid"
+              << " (+" << Asteroid_Pool::COLD_BYTES << " cold)\n"
+              << "  mismatches: " << mismatches << '\n';
+}
+
+// Homing bullets moved by shared systems over component arrays against objects
+// updating themselves (old Homing_Bullet::update), serial and with rows on job threads.
+// Every bullet steers towards its own target pos. Parallel run must match serial one exactly,
+// object version up to rounding (it rotates direction, systems rotate velocity).
+void bench_ecs()
+{
+    constexpr std::size_t BULLETS = 100'000;
+    constexpr std::size_t TICKS = 60;
+    constexpr float DT = 1.0f/60.0f;
+    constexpr float SPEED = 500.0f;
+    constexpr float ROT_SPEED = 350.0f;
+    constexpr float RADIUS = 7.0f;
+
+    const auto [w, h] = Game::get_world_size();
+    struct Spawn {
+        glm::vec2 pos;
+        glm::vec2 dir;
+        glm::vec2 target;
+    };
+    std::vector<Spawn> spawns(BULLETS);
+    for (auto& sp:spawns) {
+        const auto angle = rand_float(0.0f, 6.2831853f);
+        sp = {{rand_float(0.0f, w), rand_float(0.0f, h)}, {std::cos(angle), std::sin(angle)}, {rand_float(0.0f, w), rand_float(0.0f, h)}};
+    }
+
+    struct Object_Bullet {
+        Transform transform;
+        Transform prev_transform;
+        glm::vec2 dir;
+        glm::vec4 color;
+        peria::Handle target;
+        glm::vec2 target_pos;
+        bool dead;
+        peria::Bounds bounds;
+        uint32_t id;
+
+        void update(float dt, glm::vec2 world)
+        {
+            if (target.valid()) {
+                const auto direction = glm::normalize(target_pos - transform.pos);
+                const auto k = direction.x*dir.y - direction.y*dir.x;
+                const auto angle_delta = glm::radians((-k)*ROT_SPEED*dt);
+                dir = {std::cos(angle_delta)*dir.x - std::sin(angle_delta)*dir.y,
+                       std::sin(angle_delta)*dir.x + std::cos(angle_delta)*dir.y};
+            }
+            prev_transform = transform;
+            transform.pos += dir*SPEED*dt;
+            auto& pos = transform.pos;
+            bool wrap = false;
+            if (pos.x-RADIUS > world.x)   { pos.x -= world.x+RADIUS; wrap = true; }
+            if (pos.x+RADIUS < 0.0f)      { pos.x += world.x+RADIUS; wrap = true; }
+            if (pos.y-RADIUS > world.y)   { pos.y -= world.y+RADIUS; wrap = true; }
+            if (pos.y+RADIUS < 0.0f)      { pos.y += world.y+RADIUS; wrap = true; }
+            if (wrap) prev_transform = transform;
+            bounds = peria::swept_square_bounds(prev_transform.pos, transform.pos, RADIUS);
+        }
+    };
+    std::vector<Object_Bullet> objects;
+    objects.reserve(BULLETS);
+    for (const auto& sp:spawns) {
+        const Transform t{sp.pos, {RADIUS*2.0f, RADIUS*2.0f}, 0.0f};
+        objects.push_back({t, t, sp.dir, glm::vec4{1.0f}, peria::Handle{0, 0}, sp.target, false,
+                           peria::swept_square_bounds(sp.pos, sp.pos, RADIUS), 0});
+    }
+
+    using Bench_World = peria::World<Homing_Bullets>;
+    auto make_world = [&](Bench_World& world) {
+        auto& bullets = world.get<Homing_Bullets>();
+        bullets.reserve(BULLETS);
+        for (const auto& sp:spawns) {
+            const auto i = spawn_homing_bullet(bullets, sp.pos, RADIUS, peria::Handle{0, 0}, sp.dir, 0.0f);
+            bullets.get<Homing>()[i].target_pos = sp.target;
+        }
+    };
+    Bench_World serial;
+    Bench_World parallel;
+    make_world(serial);
+    make_world(parallel);
+
+    peria::Job_System jobs;
+    constexpr std::size_t CHUNK = 4096;
+
+    const auto object_ns = measure_ns(TICKS, [&]() {
+        for (auto& b:objects) b.update(DT, {w, h});
+    });
+    const auto serial_ns = measure_ns(TICKS, [&]() {
+        serial.run(Steer_Homing{DT});
+        serial.run(peria::Integrate{DT});
+        serial.run(peria::Wrap_Around{{w, h}});
+        serial.run(peria::Swept_Bounds{});
+    });
+    const auto parallel_ns = measure_ns(TICKS, [&]() {
+        parallel.run(jobs, CHUNK, Steer_Homing{DT});
+        parallel.run(jobs, CHUNK, peria::Integrate{DT});
+        parallel.run(jobs, CHUNK, peria::Wrap_Around{{w, h}});
+        parallel.run(jobs, CHUNK, peria::Swept_Bounds{});
+    });
+
+    const auto& a = serial.get<Homing_Bullets>();
+    const auto& b = parallel.get<Homing_Bullets>();
+    std::size_t mismatches{};
+    float max_error{};
+    for (std::size_t i{}; i<BULLETS; ++i) {
+        const auto& bounds_a = a.get<peria::Collider>()[i].bounds;
+        const auto& bounds_b = b.get<peria::Collider>()[i].bounds;
+        mismatches += a.get<Transform>()[i].pos != b.get<Transform>()[i].pos ||
+                      bounds_a.aabb.pos != bounds_b.aabb.pos || bounds_a.aabb.size != bounds_b.aabb.size;
+        max_error = std::max(max_error, glm::length(objects[i].transform.pos - a.get<Transform>()[i].pos));
+    }
+
+    std::cout << "ecs, " << BULLETS << " homing bullets, " << TICKS << " ticks, " << jobs.thread_count() << " threads\n"
+              << "  objects:         " << object_ns/1000.0 << " us/tick\n"
+              << "  systems:         " << serial_ns/1000.0 << " us/tick\n"
+              << "  systems on jobs: " << parallel_ns/1000.0 << " us/tick, mismatches: " << mismatches << '\n'
+              << "  largest distance from objects: " << max_error << '\n';
+}
+}
+
+namespace peria {
+
+// frames paced to 240 fps with no work in them: sleeping to deadline only, and Frame_Pacer
+// (sleep, then spin). Smoothed frame times summed must match measured ones.
+void bench_frame_pacer()
+{
+    constexpr double FPS = 240.0;
+    constexpr std::size_t FRAMES = 480;
+    using Clock = std::chrono::steady_clock;
+
+    peria::Frame_Times sleep_times{FRAMES};
+    {
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{1.0/FPS});
+        auto prev = Clock::now();
+        auto deadline = prev + period;
+        for (std::size_t i{}; i<FRAMES; ++i) {
+            std::this_thread::sleep_until(deadline);
+            const auto now = Clock::now();
+            sleep_times.add(std::chrono::duration<double>(now - prev).count());
+            prev = now;
+            deadline += period;
+        }
+    }
+
+    peria::Frame_Pacer pacer{FPS, FRAMES};
+    double measured{};
+    double smoothed{};
+    pacer.next_frame();
+    for (std::size_t i{}; i<FRAMES; ++i) {
+        smoothed += pacer.next_frame();
+        measured += pacer.last_frame_time();
+    }
+    const auto& pacer_times = pacer.frame_times();
+
+    const auto row = [](const char* name, const peria::Frame_Times& times) {
+        std::cout << name << "p50 " << times.percentile(0.5)*1000.0 << " ms, p99 " << times.percentile(0.99)*1000.0
+                  << " ms, max " << times.max()*1000.0 << " ms\n";
+    };
+    std::cout << "frame pacer, " << FRAMES << " frames at " << FPS << " fps (" << 1000.0/FPS << " ms)\n";
+    row("  sleep only:  ", sleep_times);
+    row("  sleep, spin: ", pacer_times);
+    std::cout << "  smoothed - measured: " << (smoothed - measured)*1000.0 << " ms over " << measured << " s\n";
+}
+
+void run_benchmarks(std::string_view filter)
+{
+    const std::pair<std::string_view, void(*)()> benchmarks[] = {
+        {"sat_simd", bench_sat_simd},
+        {"collision_allocations", bench_collision_allocations},
+        {"spatial_grid", bench_spatial_grid},
+        {"sweep_and_prune", bench_sweep_and_prune},
+        {"aabb_tree", bench_aabb_tree},
+        {"sat_cache", bench_sat_cache},
+        {"model_axes", bench_model_axes},
+        {"parallel_narrowphase", bench_parallel_narrowphase},
+        {"convex_decomposition", bench_convex_decomposition},
+        {"gjk", bench_gjk},
+        {"vertex_batch", bench_vertex_batch},
+        {"target_query", bench_target_query},
+        {"ray_cast", bench_ray_cast},
+        {"bullet_pool", bench_bullet_pool},
+        {"asteroid_models", bench_asteroid_models},
+        {"frame_arena", bench_frame_arena},
+        {"asteroid_split", bench_asteroid_split},
+        {"ecs", bench_ecs},
+        {"asteroid_layout", bench_asteroid_layout},
+        {"frame_pacer", bench_frame_pacer},
+    };
+    for (const auto& [name, bench]:benchmarks) {
+        if (name.find(filter) != std::string_view::npos) bench();
+    }
+}
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string_view>
+
+namespace peria {
+
+// Micro benchmarks for collision code on real game models.
+// Built only with -DPERIA_BENCHMARKS=ON, run with 'asteroids --bench [filter]', results are printed to stdout.
+// Only benchmarks whose name contains filter are run, empty filter runs all.
+// Use release build, debug build is not optimized.
+void run_benchmarks(std::string_view filter = {});
+
+}
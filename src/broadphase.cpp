@@ -0,0 +1,198 @@
+#include "broadphase.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace peria {
+
+Spatial_Grid::Spatial_Grid(glm::vec2 world_size, float cell_size)
+    :_cell_size{cell_size},
+     _cols{std::max(1, static_cast<int>(std::ceil(world_size.x / cell_size)))},
+     _rows{std::max(1, static_cast<int>(std::ceil(world_size.y / cell_size)))},
+     _cells(static_cast<std::size_t>(_cols*_rows))
+{
+    // cells keep their capacity between ticks, reserve up front
+    // so bullets moving between cells don't make them grow during play
+    for (auto& c:_cells) c.reserve(32);
+}
+
+void Spatial_Grid::clear()
+{
+    for (auto& c:_cells) c.clear();
+    _count = 0;
+}
+
+// visits every cell overlapped by bounds exactly once.
+// cells outside of world are wrapped to the opposite side.
+template <typename F>
+void Spatial_Grid::for_each_cell(const AABB_Collider& bounds, F&& f) const
+{
+    // AABB_Collider pos is top left corner
+    const auto min_cx = static_cast<int>(std::floor(bounds.pos.x / _cell_size));
+    const auto max_cx = static_cast<int>(std::floor((bounds.pos.x+bounds.size.x) / _cell_size));
+    const auto min_cy = static_cast<int>(std::floor((bounds.pos.y-bounds.size.y) / _cell_size));
+    const auto max_cy = static_cast<int>(std::floor(bounds.pos.y / _cell_size));
+
+    // entity bigger than world covers every column/row once
+    const auto span_x = std::min(max_cx-min_cx+1, _cols);
+    const auto span_y = std::min(max_cy-min_cy+1, _rows);
+
+    auto wrap = [](int v, int n) {
+        auto r = v%n;
+        return r < 0 ? r+n : r;
+    };
+
+    for (int y{}; y<span_y; ++y) {
+        const auto row = wrap(min_cy+y, _rows);
+        for (int x{}; x<span_x; ++x) {
+            const auto col = wrap(min_cx+x, _cols);
+            f(static_cast<std::size_t>(row*_cols + col));
+        }
+    }
+}
+
+void Spatial_Grid::insert(uint32_t id, const AABB_Collider& bounds)
+{
+    for_each_cell(bounds, [this, id](std::size_t cell) {
+        _cells[cell].push_back(id);
+    });
+    ++_count;
+}
+
+void Spatial_Grid::query(const AABB_Collider& bounds, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    for_each_cell(bounds, [this, &out](std::size_t cell) {
+        const auto& c = _cells[cell];
+        out.insert(out.end(), c.begin(), c.end());
+    });
+
+    // entity spanning several cells is reported once
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void Sweep_And_Prune::set_bounds(Interval& interval, const AABB_Collider& bounds)
+{
+    // AABB_Collider pos is top left corner
+    interval.min_x = bounds.pos.x;
+    interval.max_x = bounds.pos.x + bounds.size.x;
+    interval.min_y = bounds.pos.y - bounds.size.y;
+    interval.max_y = bounds.pos.y;
+}
+
+Sweep_And_Prune::Proxy Sweep_And_Prune::insert(const AABB_Collider& bounds, uint32_t user)
+{
+    Proxy proxy;
+    if (!_free_proxies.empty()) {
+        proxy = _free_proxies.back();
+        _free_proxies.pop_back();
+    }
+    else {
+        proxy = static_cast<Proxy>(_slots.size());
+        _slots.push_back(0);
+    }
+
+    // appended at the end, 'sort()' moves it into place
+    _slots[proxy] = static_cast<uint32_t>(_intervals.size());
+    auto& interval = _intervals.emplace_back();
+    set_bounds(interval, bounds);
+    interval.user = user;
+    interval.proxy = proxy;
+    return proxy;
+}
+
+void Sweep_And_Prune::remove(Proxy proxy)
+{
+    PERIA_ASSERT(proxy < _slots.size() && _intervals[_slots[proxy]].proxy == proxy, "removing invalid proxy");
+
+    // interval stays in place until next sort, so other slots stay valid
+    _intervals[_slots[proxy]].proxy = NONE;
+    _free_proxies.push_back(proxy);
+    ++_removed;
+}
+
+void Sweep_And_Prune::update(Proxy proxy, const AABB_Collider& bounds, uint32_t user)
+{
+    PERIA_ASSERT(proxy < _slots.size() && _intervals[_slots[proxy]].proxy == proxy, "updating invalid proxy");
+
+    auto& interval = _intervals[_slots[proxy]];
+    set_bounds(interval, bounds);
+    interval.user = user;
+}
+
+void Sweep_And_Prune::clear()
+{
+    _intervals.clear();
+    _slots.clear();
+    _free_proxies.clear();
+    _max_width = 0.0f;
+    _removed = 0;
+    _swaps = 0;
+}
+
+void Sweep_And_Prune::sort()
+{
+    // drop removed intervals, keeps relative order so intervals stay almost sorted
+    if (_removed > 0) {
+        _intervals.erase(std::remove_if(_intervals.begin(), _intervals.end(),
+                         [](const Interval& i) { return i.proxy == NONE; }),
+                         _intervals.end());
+        _removed = 0;
+    }
+
+    // insertion sort, order changes only a little between ticks
+    _swaps = 0;
+    _max_width = 0.0f;
+    for (std::size_t i{}; i<_intervals.size(); ++i) {
+        const auto tmp = _intervals[i];
+        auto j = i;
+        for (; j>0 && _intervals[j-1].min_x > tmp.min_x; --j) {
+            _intervals[j] = _intervals[j-1];
+            _slots[_intervals[j].proxy] = static_cast<uint32_t>(j);
+            ++_swaps;
+        }
+        _intervals[j] = tmp;
+        _slots[tmp.proxy] = static_cast<uint32_t>(j);
+        _max_width = std::max(_max_width, tmp.max_x - tmp.min_x);
+    }
+}
+
+void Sweep_And_Prune::query(const AABB_Collider& bounds, std::vector<uint32_t>& out) const
+{
+    out.clear();
+
+    Interval q;
+    set_bounds(q, bounds);
+
+    // first interval starting right of query can't overlap, neither can anything after it
+    auto it = std::upper_bound(_intervals.begin(), _intervals.end(), q.max_x,
+                               [](float x, const Interval& i) { return x < i.min_x; });
+
+    // walk back while interval could still reach query
+    const auto min_start = q.min_x - _max_width;
+    while (it != _intervals.begin()) {
+        --it;
+        if (it->min_x < min_start) break;
+        if (it->max_x >= q.min_x && it->min_y <= q.max_y && it->max_y >= q.min_y) {
+            out.push_back(it->user);
+        }
+    }
+}
+
+void Sweep_And_Prune::find_pairs(std::vector<std::pair<uint32_t, uint32_t>>& out) const
+{
+    out.clear();
+    for (std::size_t i{}; i<_intervals.size(); ++i) {
+        const auto& a = _intervals[i];
+        for (auto j=i+1; j<_intervals.size() && _intervals[j].min_x <= a.max_x; ++j) {
+            const auto& b = _intervals[j];
+            if (a.min_y <= b.max_y && a.max_y >= b.min_y) {
+                out.emplace_back(a.user, b.user);
+            }
+        }
+    }
+}
+
+}
+
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "physics.hpp"
+
+namespace peria {
+
+// counters for one tick of broadphase work.
+// tested - pairs handed to narrowphase.
+// culled - pairs brute force would have tested but broadphase rejected.
+struct Broadphase_Stats {
+    std::size_t pairs_tested{};
+    std::size_t pairs_culled{};
+};
+
+// Uniform grid spatial hash over toroidal world.
+// Entities are bucketed by world bounds every tick, then queried with bounds of other entities.
+// Cell coordinates wrap around world edges, since entities can be partially outside
+// of world rect before they get wrapped (see Asteroid_Pool::update_collider, peria::Wrap_Around).
+// Query may return false positives, never false negatives.
+class Spatial_Grid {
+public:
+    Spatial_Grid(glm::vec2 world_size, float cell_size);
+
+    // removes entities but keeps allocated cell storage
+    void clear();
+
+    void insert(uint32_t id, const AABB_Collider& bounds);
+
+    // writes ids of all entities that share at least one cell with bounds into out.
+    // out is sorted and without duplicates.
+    void query(const AABB_Collider& bounds, std::vector<uint32_t>& out) const;
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _count; }
+
+private:
+    template <typename F>
+    void for_each_cell(const AABB_Collider& bounds, F&& f) const;
+
+private:
+    float _cell_size;
+    int _cols;
+    int _rows;
+    std::size_t _count{};
+
+    std::vector<std::vector<uint32_t>> _cells;
+};
+
+// Persistent sweep and prune over x axis.
+// Keeps intervals sorted by min x between ticks and re-sorts them with insertion sort,
+// which is close to linear when entities move smoothly (asteroids), since order barely changes.
+// Each proxy carries user value (e.g. index into entity vector) that is reported by queries,
+// it can be changed on every update, so proxies survive erase passes that shift indices.
+// World wrapping is not handled, entities are compared at their actual world position.
+class Sweep_And_Prune {
+public:
+    using Proxy = uint32_t;
+    static constexpr Proxy NONE = std::numeric_limits<Proxy>::max();
+
+    // adds entity, it's placed into sorted order on next 'sort()'
+    [[nodiscard]]
+    Proxy insert(const AABB_Collider& bounds, uint32_t user);
+
+    // proxy can be reused by following insert
+    void remove(Proxy proxy);
+
+    void update(Proxy proxy, const AABB_Collider& bounds, uint32_t user);
+
+    // removes all proxies but keeps allocated storage
+    void clear();
+
+    // restores sorted order after updates, inserts and removes.
+    // call once per tick before queries.
+    void sort();
+
+    // writes user values of all entities overlapping bounds into out, in no particular order
+    void query(const AABB_Collider& bounds, std::vector<uint32_t>& out) const;
+
+    // writes user values of all overlapping pairs into out
+    void find_pairs(std::vector<std::pair<uint32_t, uint32_t>>& out) const;
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _intervals.size() - _removed; }
+
+    // element moves done by last 'sort()', low number means good temporal coherence
+    [[nodiscard]]
+    std::size_t last_sort_swaps() const
+    { return _swaps; }
+
+private:
+    struct Interval {
+        float min_x;
+        float max_x;
+        float min_y;
+        float max_y;
+        uint32_t user;
+        Proxy proxy; // NONE if removed, dropped on next sort
+    };
+
+    static void set_bounds(Interval& interval, const AABB_Collider& bounds);
+
+private:
+    std::vector<Interval> _intervals; // sorted by min_x after 'sort()'
+    std::vector<uint32_t> _slots; // proxy -> index into _intervals
+    std::vector<Proxy> _free_proxies;
+
+    float _max_width{}; // widest interval, limits how far back query has to look
+    std::size_t _removed{};
+    std::size_t _swaps{};
+};
+
+}
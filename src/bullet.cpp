@@ -1,5 +1,7 @@
 #include "bullet.hpp"
 
+#include <cmath>
+
 #include "graphics.hpp"
 #include "physics.hpp"
 #include "game.hpp"
@@ -7,39 +9,117 @@
 // in world space
 constexpr float SPEED = 500.0f;
 
-Bullet::Bullet(glm::vec2 world_pos, float radius, glm::vec2 dir, glm::vec4 color)
-    :_pos{world_pos}, _radius{radius}, _dir_vector{dir}, _color{color}, _dead{false}
-{}
+// per Bullet_Type
+constexpr std::array<glm::vec4, 2> COLORS{{
+    {0.5f, 0.6f, 0.7f, 1.0f},
+    {0.8f, 0.6f, 0.7f, 1.0f}
+}};
+
+Bullet_Pool::Bullet_Pool(std::size_t capacity)
+{
+    _pos.reserve(capacity);
+    _prev_pos.reserve(capacity);
+    _velocity.reserve(capacity);
+    _type.reserve(capacity);
+    _alive.reserve(capacity);
+    _bounds.reserve(capacity);
+    _ids.reserve(capacity);
+}
+
+void Bullet_Pool::spawn(glm::vec2 pos, glm::vec2 dir, Bullet_Type type)
+{
+    _pos.push_back(pos);
+    _prev_pos.push_back(pos);
+    _velocity.push_back(dir*SPEED);
+    _type.push_back(type);
+    _alive.push_back(1);
+    _bounds.push_back(peria::swept_square_bounds(pos, pos, radius(type)));
+    _ids.push_back(peria::new_entity_id());
+}
 
-void Bullet::update(float dt)
+void Bullet_Pool::update(float dt)
 {
-    _prev_pos = _pos;
+    const auto n = size();
+    auto* pos = _pos.data();
+    auto* prev_pos = _prev_pos.data();
+    const auto* velocity = _velocity.data();
+    for (std::size_t i{}; i<n; ++i) {
+        prev_pos[i] = pos[i];
+        pos[i] += velocity[i]*dt;
+    }
 
-    _pos += _dir_vector*SPEED*dt;
+    // every bullet travels SPEED*dt, so bounding circle radius only depends on type
+    std::array<float, RADIUS.size()> swept_radius;
+    for (std::size_t t{}; t<RADIUS.size(); ++t) {
+        swept_radius[t] = RADIUS[t]*std::sqrt(2.0f) + SPEED*dt*0.5f;
+    }
 
+    // Same bounds as peria::swept_square_bounds, but aabb is built from center and
+    // half extent. min and max of positions compile to branches there, which mispredict
+    // since bullets fly in every direction, std::abs doesn't.
     const auto [w, h] = Game::get_world_size();
-    if (_pos.x-_radius > w || _pos.x+_radius < 0.0f ||
-        _pos.y-_radius > h || _pos.y+_radius < 0.0f) {
-        _dead = true;
+    const auto* type = _type.data();
+    auto* alive = _alive.data();
+    auto* bounds = _bounds.data();
+    for (std::size_t i{}; i<n; ++i) {
+        const auto t = static_cast<std::size_t>(type[i]);
+        const auto r = RADIUS[t];
+        const auto p = pos[i];
+        const bool outside = (p.x-r > w) | (p.x+r < 0.0f) | (p.y-r > h) | (p.y+r < 0.0f);
+        alive[i] &= static_cast<uint8_t>(!outside);
+
+        const auto center = (prev_pos[i]+p)*0.5f;
+        const auto d = p-prev_pos[i];
+        const auto half = glm::vec2{std::abs(d.x), std::abs(d.y)}*0.5f + r;
+        bounds[i] = {center, swept_radius[t], {{center.x-half.x, center.y+half.y}, half*2.0f}};
     }
 }
 
-void Bullet::draw(Graphics& g, float alpha) const
+void Bullet_Pool::draw(Graphics& g, float alpha) const
 {
-    glm::vec2 p{peria::lerp(_prev_pos.x, _pos.x, alpha), peria::lerp(_prev_pos.y, _pos.y, alpha)};
-    g.draw_rect({p.x-_radius, p.y+_radius}, {2*_radius, 2*_radius}, _color);
+    for (std::size_t i{}; i<size(); ++i) {
+        const auto r = radius(_type[i]);
+        const glm::vec2 p{peria::lerp(_prev_pos[i].x, _pos[i].x, alpha), peria::lerp(_prev_pos[i].y, _pos[i].y, alpha)};
+        g.draw_rect({p.x-r, p.y+r}, {2*r, 2*r}, COLORS[static_cast<std::size_t>(_type[i])]);
+    }
 }
 
-void Bullet::explode()
-{ _dead = true; }
+void Bullet_Pool::remove_dead(std::pmr::vector<uint32_t>& dead_ids)
+{
+    std::size_t i{};
+    while (i < size()) {
+        if (_alive[i]) {
+            ++i;
+            continue;
+        }
+
+        dead_ids.push_back(_ids[i]);
+        const auto last = size()-1;
+        _pos[i] = _pos[last];
+        _prev_pos[i] = _prev_pos[last];
+        _velocity[i] = _velocity[last];
+        _type[i] = _type[last];
+        _alive[i] = _alive[last];
+        _bounds[i] = _bounds[last];
+        _ids[i] = _ids[last];
+
+        _pos.pop_back();
+        _prev_pos.pop_back();
+        _velocity.pop_back();
+        _type.pop_back();
+        _alive.pop_back();
+        _bounds.pop_back();
+        _ids.pop_back();
+    }
+}
 
-// in clockwise order
-std::vector<glm::vec2> Bullet::get_world_points() const
+void Bullet_Pool::clear()
 {
-    return {
-        {_pos.x-_radius, _pos.y+_radius},
-        {_pos.x+_radius, _pos.y+_radius},
-        {_pos.x+_radius, _pos.y-_radius},
-        {_pos.x-_radius, _pos.y-_radius}
-    };
+    _pos.clear();
+    _prev_pos.clear();
+    _velocity.clear();
+    _type.clear();
+    _alive.clear();
+    _bounds.clear();
+    _ids.clear();
 }
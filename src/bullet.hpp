@@ -2,37 +2,135 @@
 
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 
+#include "physics.hpp"
+#include "peria_utils.hpp"
+
 class Graphics;
+class Bullet;
 
-class Bullet {
+// weapon that fired bullet, decides its size and color
+enum class Bullet_Type : uint8_t {
+    GUN = 0,
+    SHOTGUN
+};
+
+// All bullets of gun and shotgun, stored as structure of arrays so 'update' is
+// a few plain loops over positions. Storage is reserved up front, so shooting doesn't
+// allocate until capacity is exceeded. Dead bullets are removed by moving last bullet
+// into their place, so indices of bullets change in 'remove_dead' and nowhere else.
+class Bullet_Pool {
 public:
-    Bullet() = default;
-    Bullet(glm::vec2 world_pos, float radius, glm::vec2 dir, glm::vec4 color);
+    explicit Bullet_Pool(std::size_t capacity = 4096);
 
+    // pos is center of bullet, dir is normalized
+    void spawn(glm::vec2 pos, glm::vec2 dir, Bullet_Type type);
+
+    // moves bullets, marks ones that left world dead and refreshes bounds
     void update(float dt);
     void draw(Graphics& g, float alpha) const;
 
+    void explode(std::size_t i)
+    { _alive[i] = 0; }
+
+    // swap and pop every dead bullet, appends their ids to dead_ids
+    void remove_dead(std::pmr::vector<uint32_t>& dead_ids);
+
+    void clear();
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _pos.size(); }
+
+    [[nodiscard]]
+    Bullet operator[](std::size_t i) const;
+
+    // half side of bullet square
+    [[nodiscard]]
+    static float radius(Bullet_Type type)
+    { return RADIUS[static_cast<std::size_t>(type)]; }
+
+private:
+    friend class Bullet;
+
+    static constexpr std::array<float, 2> RADIUS{4.5f, 5.0f};
+
+    std::vector<glm::vec2> _pos;
+    std::vector<glm::vec2> _prev_pos;
+    std::vector<glm::vec2> _velocity;
+    std::vector<Bullet_Type> _type;
+    std::vector<uint8_t> _alive; // 0 once bullet hit something or left world
+    std::vector<peria::Bounds> _bounds;
+    std::vector<uint32_t> _ids;
+};
+
+// Read only view of one bullet in pool, valid until pool removes or spawns bullets.
+// Same interface as Homing_Bullet, so narrowphase code takes either.
+class Bullet {
+public:
+    Bullet(const Bullet_Pool& pool, std::size_t index)
+        :_pool{&pool}, _i{index}
+    {}
+
+    // square in clockwise order, no heap allocation
+    [[nodiscard]]
+    std::array<glm::vec2, 4> get_world_points() const
+    { return square(_pool->_pos[_i]); }
+
+    // same square at position from previous tick, start of swept collision test
     [[nodiscard]]
-    std::vector<glm::vec2> get_world_points() const;
+    std::array<glm::vec2, 4> get_prev_world_points() const
+    {
+        auto points = get_world_points();
+        for (auto& p:points) p -= get_displacement();
+        return points;
+    }
 
+    // distance travelled during last tick
     [[nodiscard]]
-    glm::vec2 get_world_pos() const 
-    { return _pos; }
+    glm::vec2 get_displacement() const
+    { return _pool->_pos[_i] - _pool->_prev_pos[_i]; }
 
     [[nodiscard]]
-    bool dead() const 
-    { return _dead; }
+    glm::vec2 get_world_pos() const
+    { return _pool->_pos[_i]; }
 
-    void explode();
+    // bounding circle and aabb of path travelled during last tick
+    [[nodiscard]]
+    const peria::Bounds& get_bounds() const
+    { return _pool->_bounds[_i]; }
+
+    // stable id, keys per pair caches
+    [[nodiscard]]
+    uint32_t get_id() const
+    { return _pool->_ids[_i]; }
+
+    [[nodiscard]]
+    bool dead() const
+    { return !_pool->_alive[_i]; }
 
 private:
-    glm::vec2 _pos;
-    glm::vec2 _prev_pos;
+    [[nodiscard]]
+    std::array<glm::vec2, 4> square(glm::vec2 c) const
+    {
+        const auto r = Bullet_Pool::radius(_pool->_type[_i]);
+        return {{
+            {c.x-r, c.y+r},
+            {c.x+r, c.y+r},
+            {c.x+r, c.y-r},
+            {c.x-r, c.y-r}
+        }};
+    }
 
-    float _radius;
-    glm::vec2 _dir_vector;
-    glm::vec4 _color;
-    bool _dead;
+private:
+    const Bullet_Pool* _pool;
+    std::size_t _i;
 };
+
+inline
+Bullet Bullet_Pool::operator[](std::size_t i) const
+{ return {*this, i}; }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <cstdint>
+
+#include "transform.hpp"
+#include "physics.hpp"
+#include "aabb_tree.hpp"
+
+namespace peria {
+
+// Components shared by entity types stored in World (see ecs.hpp).
+// Plain data, behaviour lives in systems (see systems.hpp).
+
+// transform at end of previous tick, start of swept tests and interpolated drawing
+struct Prev_Transform : Transform {};
+
+struct Velocity {
+    glm::vec2 linear{};
+    float angular{}; // degrees per second
+};
+
+// bounds in world space, proxy is set if entity is in collider tree
+struct Collider {
+    Bounds bounds{};
+    Aabb_Tree::Proxy proxy{Aabb_Tree::NONE};
+};
+
+// entity is removed at end of tick once hp is 0
+struct Health {
+    uint8_t hp{1};
+};
+
+// drawn as rect of transform scale, centered at transform pos
+struct Renderable {
+    glm::vec4 color{1.0f};
+};
+
+}
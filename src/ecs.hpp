@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "job_system.hpp"
+#include "peria_utils.hpp"
+
+namespace peria {
+
+// components a system reads or writes, see World::run
+template <typename... Cs>
+struct Query {};
+
+// All entities made of exactly components Cs. Every component has its own contiguous
+// array and entity is the same row in all of them, so systems loop over plain arrays.
+// Dead entities are removed by moving last row into their place, so rows change in
+// 'remove' and nowhere else. Every entity also gets stable id, same as Bullet_Pool.
+template <typename... Cs>
+class Archetype {
+public:
+    template <typename C>
+    static constexpr bool has = (std::is_same_v<C, Cs> || ...);
+
+    // appends entity, returns its row
+    std::size_t create(Cs... components)
+    {
+        (column<Cs>().push_back(std::move(components)), ...);
+        _ids.push_back(new_entity_id());
+        return _ids.size()-1;
+    }
+
+    // last entity takes row i
+    void remove(std::size_t i)
+    {
+        const auto last = size()-1;
+        if (i != last) {
+            ((column<Cs>()[i] = std::move(column<Cs>()[last])), ...);
+            _ids[i] = _ids[last];
+        }
+        (column<Cs>().pop_back(), ...);
+        _ids.pop_back();
+    }
+
+    void reserve(std::size_t capacity)
+    {
+        (column<Cs>().reserve(capacity), ...);
+        _ids.reserve(capacity);
+    }
+
+    void clear()
+    {
+        (column<Cs>().clear(), ...);
+        _ids.clear();
+    }
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _ids.size(); }
+
+    [[nodiscard]]
+    bool empty() const
+    { return _ids.empty(); }
+
+    template <typename C>
+    [[nodiscard]]
+    std::span<C> get()
+    { return column<C>(); }
+
+    template <typename C>
+    [[nodiscard]]
+    std::span<const C> get() const
+    { return std::get<std::vector<C>>(_columns); }
+
+    // stable ids, keys per pair caches
+    [[nodiscard]]
+    std::span<const uint32_t> ids() const
+    { return _ids; }
+
+private:
+    template <typename C>
+    [[nodiscard]]
+    std::vector<C>& column()
+    {
+        static_assert(has<C>, "archetype doesn't have this component");
+        return std::get<std::vector<C>>(_columns);
+    }
+
+private:
+    std::tuple<std::vector<Cs>...> _columns;
+    std::vector<uint32_t> _ids;
+};
+
+// Every archetype of game. Systems ask for components instead of entity types, so they
+// run over every archetype that has them, and new entity type is one more archetype here.
+//
+// Per entity system is a function object with member type Query listing its components,
+// called with one row of them at a time:
+//
+//     struct Integrate {
+//         using Query = peria::Query<Transform, Prev_Transform, Velocity>;
+//         float dt;
+//         void operator()(Transform& t, Prev_Transform& prev, Velocity& v) const;
+//     };
+//     world.run(Integrate{dt});
+//
+// Systems that need whole archetype (removing, drawing) use 'each_archetype'.
+template <typename... Archetypes>
+class World {
+public:
+    template <typename A>
+    [[nodiscard]]
+    A& get()
+    { return std::get<A>(_archetypes); }
+
+    template <typename A>
+    [[nodiscard]]
+    const A& get() const
+    { return std::get<A>(_archetypes); }
+
+    // calls f(archetype) for every archetype that has all of Cs
+    template <typename... Cs, typename F>
+    void each_archetype(F&& f)
+    {
+        std::apply([&](auto&... archetype) {
+            ([&](auto& a) {
+                if constexpr ((std::remove_reference_t<decltype(a)>::template has<Cs> && ...)) f(a);
+            }(archetype), ...);
+        }, _archetypes);
+    }
+
+    // calls f(Cs&...) for every entity that has all of Cs, archetype after archetype
+    template <typename... Cs, typename F>
+    void each(F&& f)
+    {
+        each_archetype<Cs...>([&](auto& a) {
+            const auto columns = std::make_tuple(a.template get<Cs>()...);
+            for (std::size_t i{}; i<a.size(); ++i) f(std::get<std::span<Cs>>(columns)[i]...);
+        });
+    }
+
+    // Same as 'each', rows are split into chunks run on job threads.
+    // f may only write components of row it was called with.
+    template <typename... Cs, typename F>
+    void parallel_each(Job_System& jobs, std::size_t chunk_size, F&& f)
+    {
+        each_archetype<Cs...>([&](auto& a) {
+            const auto columns = std::make_tuple(a.template get<Cs>()...);
+            jobs.parallel_for(a.size(), chunk_size, [&](std::size_t begin, std::size_t end, std::size_t) {
+                for (auto i=begin; i<end; ++i) f(std::get<std::span<Cs>>(columns)[i]...);
+            });
+        });
+    }
+
+    template <typename System>
+    void run(System&& system)
+    { run_query(system, typename std::remove_cvref_t<System>::Query{}); }
+
+    template <typename System>
+    void run(Job_System& jobs, std::size_t chunk_size, System&& system)
+    { run_query(jobs, chunk_size, system, typename std::remove_cvref_t<System>::Query{}); }
+
+    void clear()
+    { std::apply([](auto&... a) { (a.clear(), ...); }, _archetypes); }
+
+    // entities in all archetypes
+    [[nodiscard]]
+    std::size_t size() const
+    { return std::apply([](const auto&... a) { return (a.size() + ... + std::size_t{}); }, _archetypes); }
+
+private:
+    template <typename System, typename... Cs>
+    void run_query(System& system, Query<Cs...>)
+    { each<Cs...>(system); }
+
+    template <typename System, typename... Cs>
+    void run_query(Job_System& jobs, std::size_t chunk_size, System& system, Query<Cs...>)
+    { parallel_each<Cs...>(jobs, chunk_size, system); }
+
+private:
+    std::tuple<Archetypes...> _archetypes;
+};
+
+// Runs independent systems at once, one job each, blocks until all are done.
+// They must not write anything another one reads or writes, and can't use
+// 'jobs' themselves (use World::each inside, not parallel_each).
+template <typename... Systems>
+void run_parallel(Job_System& jobs, Systems&&... systems)
+{
+    jobs.parallel_for(sizeof...(Systems), 1, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (auto i=begin; i<end; ++i) {
+            std::size_t k{};
+            ((k++ == i ? (void)systems() : (void)0), ...);
+        }
+    });
+}
+
+}
@@ -0,0 +1,23 @@
+#include "frame_arena.hpp"
+
+namespace peria {
+
+Frame_Arena::Frame_Arena(std::size_t capacity)
+    :_capacity{capacity},
+     _buffer{std::make_unique<std::byte[]>(capacity)},
+     _arena{_buffer.get(), _capacity, &_upstream}
+{}
+
+void Frame_Arena::reset()
+{ _arena.release(); }
+
+void* Frame_Arena::Counting_Resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    ++blocks;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void Frame_Arena::Counting_Resource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{ std::pmr::new_delete_resource()->deallocate(p, bytes, alignment); }
+
+}
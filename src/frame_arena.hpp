@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace peria {
+
+// Bump allocator for temporaries that live at most one fixed step (or one frame).
+// Memory comes from one buffer allocated up front, deallocation does nothing and
+// 'reset' frees everything at once. Use it through std::pmr containers, e.g.
+// std::pmr::vector<T> v{arena.resource()}, and don't keep them past 'reset'.
+// Can also back a std::pmr pool resource for data that lives as long as something else
+// (e.g. a level), reset it only after pool is released then.
+// If buffer runs out, extra blocks come from heap until next 'reset', 'overflows' counts them.
+class Frame_Arena {
+public:
+    explicit Frame_Arena(std::size_t capacity);
+
+    Frame_Arena(const Frame_Arena&) = delete;
+    Frame_Arena& operator=(const Frame_Arena&) = delete;
+
+    // everything allocated since last reset is gone, buffer is reused from start
+    void reset();
+
+    [[nodiscard]]
+    std::pmr::memory_resource* resource()
+    { return &_arena; }
+
+    [[nodiscard]]
+    std::size_t capacity() const
+    { return _capacity; }
+
+    // heap blocks requested because buffer was too small, since construction
+    [[nodiscard]]
+    std::size_t overflows() const
+    { return _upstream.blocks; }
+
+private:
+    // passes blocks to heap and counts them
+    struct Counting_Resource : std::pmr::memory_resource {
+        std::size_t blocks{};
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        { return this == &other; }
+    };
+
+    std::size_t _capacity;
+    std::unique_ptr<std::byte[]> _buffer;
+    Counting_Resource _upstream;
+    std::pmr::monotonic_buffer_resource _arena;
+};
+
+}
@@ -0,0 +1,138 @@
+#include "frame_pacer.hpp"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+
+#include "peria_logger.hpp"
+
+namespace {
+    constexpr double SMOOTHING = 0.1; // weight of newest frame time
+    constexpr double PAYBACK = 0.25; // part of debt paid back every frame
+
+    // sleeps wake up late by up to few ms, last this many seconds before deadline are spun
+    constexpr double INITIAL_SPIN_MARGIN = 0.002;
+    constexpr double MIN_SPIN_MARGIN = 0.0005;
+    constexpr double MAX_SPIN_MARGIN = 0.004;
+    constexpr double MARGIN_DECAY = 0.99; // per sleep, so one late wake up doesn't keep margin high
+}
+
+namespace peria {
+
+Frame_Times::Frame_Times(std::size_t capacity)
+    :_times(std::max<std::size_t>(capacity, 1))
+{
+    _sorted.reserve(_times.size());
+}
+
+void Frame_Times::add(double seconds)
+{
+    _times[_next] = seconds;
+    _next = (_next+1) % _times.size();
+    _size = std::min(_size+1, _times.size());
+}
+
+void Frame_Times::clear()
+{
+    _next = 0;
+    _size = 0;
+}
+
+double Frame_Times::percentile(double q) const
+{
+    if (_size == 0) return 0.0;
+
+    // frames in ring are [0, _size) until it is full, order doesn't matter
+    _sorted.assign(_times.begin(), _times.begin() + _size);
+    const auto rank = static_cast<std::size_t>(std::ceil(std::clamp(q, 0.0, 1.0)*_size));
+    const auto nth = _sorted.begin() + (rank > 0 ? rank-1 : 0);
+    std::nth_element(_sorted.begin(), nth, _sorted.end());
+    return *nth;
+}
+
+double Frame_Times::max() const
+{
+    if (_size == 0) return 0.0;
+    return *std::max_element(_times.begin(), _times.begin() + _size);
+}
+
+Frame_Pacer::Frame_Pacer(double target_fps, std::size_t report_window)
+    :_frequency{SDL_GetPerformanceFrequency()},
+     _spin_margin{INITIAL_SPIN_MARGIN},
+     _times{report_window},
+     _report_window{report_window}
+{
+    set_target_fps(target_fps);
+}
+
+void Frame_Pacer::set_target_fps(double fps)
+{
+    _target_fps = std::max(fps, 0.0);
+    _period = (_target_fps > 0.0) ? static_cast<uint64_t>(_frequency/_target_fps) : 0;
+    if (_prev != 0) _deadline = _prev + _period;
+}
+
+float Frame_Pacer::next_frame()
+{
+    if (_period > 0 && _prev != 0) wait_until(_deadline);
+
+    const auto now = SDL_GetPerformanceCounter();
+    if (_prev == 0) {
+        _prev = now;
+        _deadline = now + _period;
+        return 0.0f;
+    }
+
+    _last = static_cast<double>(now - _prev)/_frequency;
+    _prev = now;
+
+    // frames are due every period from first one, frame late by more than period
+    // starts over so next ones are not rushed to catch up
+    _deadline += _period;
+    if (_deadline < now) _deadline = now + _period;
+
+    _times.add(_last);
+    if (++_frames >= _report_window) report();
+
+    return smooth(_last);
+}
+
+void Frame_Pacer::wait_until(uint64_t deadline)
+{
+    // sleep in whole ms while more than spin margin is left
+    for (;;) {
+        const auto now = SDL_GetPerformanceCounter();
+        if (now >= deadline) return;
+
+        const auto remaining = static_cast<double>(deadline - now)/_frequency;
+        const auto ms = static_cast<uint32_t>((remaining - _spin_margin)*1000.0);
+        if (remaining <= _spin_margin || ms == 0) break;
+
+        SDL_Delay(ms);
+        const auto slept = static_cast<double>(SDL_GetPerformanceCounter() - now)/_frequency;
+        const auto late = slept - ms/1000.0;
+        _spin_margin = std::clamp(std::max(late, _spin_margin*MARGIN_DECAY), MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+    }
+
+    while (SDL_GetPerformanceCounter() < deadline) {}
+}
+
+float Frame_Pacer::smooth(double frame_time)
+{
+    const auto t = std::min(frame_time, MAX_FRAME_TIME);
+    if (_smoothed == 0.0) _smoothed = t;
+    _smoothed += (t - _smoothed)*SMOOTHING;
+
+    const auto dt = std::clamp(_smoothed + _debt*PAYBACK, 0.0, MAX_FRAME_TIME);
+    _debt += t - dt;
+    return static_cast<float>(dt);
+}
+
+void Frame_Pacer::report()
+{
+    PERIA_LOG("frame time: p50 ", _times.percentile(0.5)*1000.0, " ms, p99 ", _times.percentile(0.99)*1000.0,
+              " ms, max ", _times.max()*1000.0, " ms over ", _times.size(), " frames");
+    _frames = 0;
+}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace peria {
+
+// Frame times of last 'capacity' frames, oldest are overwritten.
+class Frame_Times {
+public:
+    explicit Frame_Times(std::size_t capacity = 600);
+
+    void add(double seconds);
+    void clear();
+
+    // q in [0, 1], nearest rank. 0 if empty
+    [[nodiscard]]
+    double percentile(double q) const;
+
+    [[nodiscard]]
+    double max() const;
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _size; }
+
+    [[nodiscard]]
+    std::size_t capacity() const
+    { return _times.size(); }
+
+private:
+    std::vector<double> _times; // ring buffer
+    mutable std::vector<double> _sorted; // scratch of 'percentile', sized once
+    std::size_t _next{};
+    std::size_t _size{};
+};
+
+// Paces main loop on SDL performance counter.
+// With target fps 0 frames are not waited for, vsync (if on) paces them in buffer swap.
+// Otherwise 'next_frame' waits for next frame by sleeping most of remaining time and spinning
+// the rest, spin margin follows how late sleeps of this system wake up.
+// Frame time handed to game is smoothed. What smoothing holds back is paid back over next frames,
+// so game time doesn't drift from real time.
+// Every 'report_window' frames p50, p99 and max frame time are logged in debug builds.
+class Frame_Pacer {
+public:
+    explicit Frame_Pacer(double target_fps = 0.0, std::size_t report_window = 600);
+
+    // 0 - no limit
+    void set_target_fps(double fps);
+
+    [[nodiscard]]
+    double get_target_fps() const
+    { return _target_fps; }
+
+    // Waits until next frame is due, returns smoothed seconds since previous call (0 on first call).
+    // Frame times longer than MAX_FRAME_TIME (window dragged, debugger) are cut to it.
+    float next_frame();
+
+    // measured seconds of last frame, not smoothed or cut
+    [[nodiscard]]
+    double last_frame_time() const
+    { return _last; }
+
+    [[nodiscard]]
+    const Frame_Times& frame_times() const
+    { return _times; }
+
+    static constexpr double MAX_FRAME_TIME = 0.25;
+
+private:
+    void wait_until(uint64_t deadline);
+
+    [[nodiscard]]
+    float smooth(double frame_time);
+
+    void report();
+
+private:
+    double _target_fps{};
+    uint64_t _frequency; // counts per second
+    uint64_t _period{}; // counts per frame, 0 - no limit
+    uint64_t _prev{}; // counter at start of previous frame, 0 before first frame
+    uint64_t _deadline{}; // counter at which next frame is due
+
+    double _spin_margin; // seconds before deadline sleeping stops
+    double _smoothed{};
+    double _debt{}; // seconds real time is ahead of game time
+    double _last{};
+
+    Frame_Times _times;
+    std::size_t _report_window;
+    std::size_t _frames{}; // since last report
+};
+
+}
@@ -2,8 +2,10 @@
 
 #include <SDL2/SDL.h>
 #include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <sstream>
+#include <type_traits>
 #include <fstream>
 #include <filesystem>
 
@@ -17,6 +19,7 @@
 #include "asteroid.hpp"
 #include "bullet.hpp"
 #include "homing_bullet.hpp"
+#include "systems.hpp"
 
 #include "helper.hpp"
 
@@ -32,6 +35,8 @@ constexpr glm::vec4 DISABLED_UPGRADE_BUTTON_COLOR_BORDER{0.502f, 0.502f, 0.502f,
 
 constexpr glm::vec4 WHITE{1.0f, 1.0f, 1.0f, 1.0f};
 
+constexpr double MAX_FPS_WITHOUT_VSYNC = 144.0;
+
 struct Stats {
     float total_time{};
     int level_count{};
@@ -92,7 +97,8 @@ Game::Game(Graphics& graphics, Input_Manager& input_manager)
      _active_weapon{Active_Weapon::GUN},
      _level_id{0}
 {
-    _bullets.reserve(512); // reserve some space since we know we will shoot a lot
+    _candidates.reserve(64);
+    _thread_stats.resize(_jobs.thread_count());
     _level_init_calls.reserve(5);
     _level_init_calls.push_back(std::bind(&Game::init_level1, this));
     _level_init_calls.push_back(std::bind(&Game::init_level2, this));
@@ -212,16 +218,24 @@ Game::Game(Graphics& graphics, Input_Manager& input_manager)
 Game::~Game()
 { PERIA_LOG("Game dtor()"); }
 
+void Game::set_tick_rate(float hz)
+{
+    PERIA_ASSERT(hz >= MIN_TICK_RATE && hz <= MAX_TICK_RATE, "tick rate out of range");
+    // release builds keep step finite and positive, nan keeps current rate
+    if (std::isnan(hz)) return;
+    _step = 1.0f/std::clamp(hz, MIN_TICK_RATE, MAX_TICK_RATE);
+}
+
 void Game::run()
 {
-    uint32_t prev = SDL_GetTicks();
+    // vsync paces frames in buffer swap, without it frames are limited here
+    _frame_pacer.set_target_fps(_graphics.get_vsync() ? 0.0 : MAX_FPS_WITHOUT_VSYNC);
+
     float accumulator = 0.0f;
-    constexpr float step = 1.0f/60.0f;
+    const float step = _step;
 
     while (_running) {
-        uint32_t now = SDL_GetTicks();
-        float frame_time = (now - prev) / 1000.0f; // delta time in seconds
-        prev = now;
+        const float frame_time = _frame_pacer.next_frame(); // seconds, smoothed
 
         _input_manager.update_mouse();
 
@@ -242,7 +256,9 @@ void Game::run()
         // fixed loop here
         while (accumulator >= step) {
             // do physics and game logic updates here
+            _tick_allocations.begin_tick();
             update(step);
+            _tick_allocations.end_tick();
             accumulator -= step;
 
             _input_manager.update_prev_state();
@@ -251,8 +267,6 @@ void Game::run()
         auto alpha = accumulator / step;
 
         render(alpha);
-
-        SDL_Delay(1);
     }
 }
 
@@ -272,25 +286,26 @@ void Game::render(float alpha)
             break;
         case Game_State::PLAYING:
         {
+            // outlines at interpolated transforms, expanded once per frame
+            _frame_vertices.clear();
             for (const auto& a:_asteroids) {
-                a.draw(_graphics, alpha);
+                _frame_vertices.add(a.get_model(), a.get_interpolated_transform(alpha));
             }
+            const auto ship_entry = _frame_vertices.add(_ship->get_model(), _ship->get_interpolated_transform(alpha));
+            _frame_vertices.expand();
 
-            _ship->draw(_graphics, alpha);
-
-            for (const auto& c:_gun_collectibles) {
-                if (c.type==Collectible::Collectible_Type::SHOTGUN)
-                    _graphics.draw_rect(c.pos, c.size, {1.0f, 1.0f, 0.0f, 1.0f});
-                else
-                    _graphics.draw_rect(c.pos, c.size, {0.4f, 1.0f, 0.4f, 1.0f});
+            for (std::size_t i{}; i<_asteroids.size(); ++i) {
+                _asteroids[i].draw(_graphics, alpha, _frame_vertices.vertices(i));
             }
 
-            for (const auto& b:_bullets) {
-                b.draw(_graphics, alpha);
-            }
+            _ship->draw(_graphics, _frame_vertices.vertices(ship_entry));
+
+            peria::draw_rects(_entities, _graphics, alpha); // collectibles and homing bullets
 
-            for (const auto& b:_homing_bullets) {
-                b.draw(_graphics, alpha);
+            _bullets.draw(_graphics, alpha);
+
+            if (_active_weapon == Active_Weapon::HOMING_GUN) {
+                _homing_gun.draw_radar(_graphics, _ship->get_interpolated_transform(alpha).pos);
             }
 
             { // draw ship hp points
@@ -313,6 +328,21 @@ void Game::render(float alpha)
             if (_active_weapon == Active_Weapon::HOMING_GUN) {
                 _graphics.draw_text("HomingGun: " + std::to_string(static_cast<int>(_homing_gun.timer())), {0.0f, h-55}, text_color, 30);
             }
+        #ifdef PERIA_DEBUG
+            _graphics.draw_text("pairs tested: " + std::to_string(_broadphase_stats.pairs_tested) +
+                                " culled: " + std::to_string(_broadphase_stats.pairs_culled),
+                                {0.0f, 10.0f}, text_color, 30, 0.6f);
+            _graphics.draw_text("narrowphase calls: " + std::to_string(_narrowphase_stats.calls) +
+                                " circle rejected: " + std::to_string(_narrowphase_stats.circle_rejected) +
+                                " aabb rejected: " + std::to_string(_narrowphase_stats.aabb_rejected) +
+                                " sat rejected: " + std::to_string(_narrowphase_stats.sat_rejected),
+                                {0.0f, 30.0f}, text_color, 30, 0.6f);
+            _graphics.draw_text("sat cache hits: " + std::to_string(_sat_cache.stats().hits) +
+                                " stale: " + std::to_string(_sat_cache.stats().stale) +
+                                " misses: " + std::to_string(_sat_cache.stats().misses) +
+                                " pairs: " + std::to_string(_sat_cache.size()),
+                                {0.0f, 50.0f}, text_color, 30, 0.6f);
+        #endif
         } break;
         case Game_State::DEAD:
         {
@@ -448,6 +478,8 @@ void Game::update_main_menu_state()
 
 void Game::update_playing_state(float dt)
 {
+    reset_tick_arena();
+
     if (_input_manager.key_pressed(SDL_SCANCODE_P)) {
         _state = Game_State::PAUSED;
         return;
@@ -478,49 +510,30 @@ void Game::update_playing_state(float dt)
             PERIA_LOG("WTF?");
     }
 
-    for (auto& a:_asteroids) { 
-        a.update(dt);
-    }
+    _asteroids.update(dt);
 
     _ship->update(_input_manager, dt);
 
-    // this is polygon collider for the ship
-    // Note that since we don't use sprites, entities visual and colliders are the same
-    peria::Polygon ship_poly{_ship->get_points_in_world()};
-    const auto& ship_tip = ship_poly.points()[2]; // tip of ship in world space
-    
-    // collectible picking logic
-    {
-        for (auto& c:_gun_collectibles) {
-            peria::Polygon collectibe_poly{{
-                {c.pos.x, c.pos.y},
-                {c.pos.x+c.size.x, c.pos.y},
-                {c.pos.x+c.size.x, c.pos.y-c.size.y},
-                {c.pos.x, c.pos.y-c.size.y}
-            }};
-
-            // take shotgun
-            if (concave_sat(ship_poly, collectibe_poly)) {
-                switch (c.type) {
-                    case Collectible::Collectible_Type::SHOTGUN:
-                        _active_weapon = Active_Weapon::SHOTGUN;
-                        _shotgun.reset();
-                        break;
-                    case Collectible::Collectible_Type::HOMING_GUN:
-                        _active_weapon = Active_Weapon::HOMING_GUN;
-                        _homing_gun.reset();
-                        break;
-                    default:
-                        break;
-                }
-                c.taken = true;
-            }
-        }
+    // outlines of asteroids and ship moved to world space in one batch,
+    // colliders are gathered from it and wrapped around world edges
+    _tick_vertices.clear();
+    for (const auto& a:_asteroids) {
+        _tick_vertices.add(a.get_model(), a.get_transform());
+    }
+    const auto ship_entry = _tick_vertices.add(_ship->get_model(), _ship->get_transform());
+    _tick_vertices.expand();
+    for (std::size_t i{}; i<_asteroids.size(); ++i) {
+        _asteroids.update_collider(i, _tick_vertices.vertices(i));
+    }
+    _ship->update_collider(_tick_vertices.vertices(ship_entry));
+
+    const auto ship_tip = _ship->get_tip_in_world();
 
-        // remove collected collectibles
-        _gun_collectibles.erase(std::remove_if(_gun_collectibles.begin(), _gun_collectibles.end(), 
-                       [](const Collectible& c) { return c.taken; }),
-                       _gun_collectibles.end());
+    sync_collider_tree();
+
+    if (_active_weapon == Active_Weapon::HOMING_GUN) {
+        const auto [w, h] = get_world_size();
+        _homing_gun.update_radar(ship_tip, _asteroids, _collider_tree, {w, h}, asteroid_index);
     }
 
     // logic for bullets shooting based on weapon
@@ -539,8 +552,14 @@ void Game::update_playing_state(float dt)
                     break;
                 case Active_Weapon::HOMING_GUN:
                     if (_homing_gun.delay() <= 0.0f) {
-                        _target_index = _homing_gun.search(ship_tip, _asteroids);
-                        _asteroids[_target_index].set_color({1.0f, 0.5f, 1.0f, 1.0f});
+                        const auto [w, h] = get_world_size();
+                        const auto target = _homing_gun.search(ship_tip, _ship->get_direction_vector(), _asteroids,
+                                                               _collider_tree, {w, h}, asteroid_index);
+                        _target = {};
+                        if (target != -1) {
+                            _target = _asteroids[target].get_handle();
+                            _asteroids[target].set_color({1.0f, 0.5f, 1.0f, 1.0f});
+                        }
                     }
                     break;
                 default:
@@ -550,32 +569,220 @@ void Game::update_playing_state(float dt)
 
         if (_input_manager.key_released(SDL_SCANCODE_SPACE) &&
             _active_weapon == Active_Weapon::HOMING_GUN && 
-            _homing_gun.delay() <= 0.0f && _target_index != -1) {
-            _homing_bullets.emplace_back(ship_tip, 7.0f, _target_index, _ship->get_direction_vector(), _ship->get_angle(), glm::vec4{1.0f, 1.0f, 0.0f, 1.0f});
-            _target_index = -1;
+            _homing_gun.delay() <= 0.0f && _asteroid_handles.alive(_target)) {
+            spawn_homing_bullet(_entities.get<Homing_Bullets>(), ship_tip, 7.0f, _target, _ship->get_direction_vector(), _ship->get_angle());
+            _target = {};
             _homing_gun.do_delay();
         }
     }
 
-    for (auto& b:_bullets) {
-        b.update(dt);
+    // target that was destroyed doesn't resolve any more, bullet keeps flying in last direction
+    for (auto& homing:_entities.get<Homing_Bullets>().get<Homing>()) {
+        if (const auto target = _asteroid_handles.resolve(homing.target); target != peria::Handle::NONE) {
+            homing.target_pos = _asteroids[target].get_world_pos();
+            _asteroids[target].set_color({1.0f, 0.5f, 1.0f, 1.0f});
+        }
+        else {
+            homing.target = {};
+        }
+    }
+
+    // gun bullets and entities don't share any data, so they move at once
+    {
+        const auto [w, h] = get_world_size();
+        peria::run_parallel(_jobs,
+            [&]() { _bullets.update(dt); },
+            [&]() {
+                _entities.run(Steer_Homing{dt});
+                _entities.run(peria::Integrate{dt});
+                _entities.run(peria::Wrap_Around{{w, h}});
+                _entities.run(peria::Swept_Bounds{});
+            });
+    }
+
+    detect_collisions();
+    if (!resolve_collisions()) return;
+
+    // ids of entities that die this tick, their cached pairs are evicted
+    _dead_ids.clear();
+
+    _bullets.remove_dead(_dead_ids);
+
+    _asteroids.remove_dead([this](const Asteroid& a) {
+        _collider_tree.remove(a.get_broadphase_proxy());
+        _asteroid_handles.release(a.get_handle());
+        _dead_ids.push_back(a.get_id());
+    });
+
+    // homing bullets that hit and taken collectibles
+    peria::remove_dead(_entities, _collider_tree, _dead_ids);
+
+    std::sort(_dead_ids.begin(), _dead_ids.end());
+    _sat_cache.evict(_dead_ids);
+
+    if (_asteroids.empty()) {
+        ++_upgrade_count;
+        current_stats.total_time += current_time;
+        ++current_stats.level_count;
+        _state = Game_State::WON;
     }
+}
+
+void Game::reset_tick_arena()
+{
+    // containers let go of arena memory before it is reused
+    auto drop = [](auto& v) { v = std::remove_reference_t<decltype(v)>{v.get_allocator()}; };
+    drop(_bullet_hits);
+    drop(_collision_events);
+    drop(_sweep_pairs);
+    drop(_dead_ids);
+    _tick_arena.reset();
+
+    // room for usual tick up front, so they don't grow and leave old copies in arena
+    _bullet_hits.reserve(512);
+    _collision_events.reserve(256);
+    _sweep_pairs.reserve(1024);
+    _dead_ids.reserve(512);
+}
+
+void Game::detect_collisions()
+{
+    _collision_events.clear();
+    _broadphase_stats = {};
+    _narrowphase_stats = {};
+    _sat_cache.reset_stats();
+
+    // convex pieces are polygon collider for the ship
+    // Note that since we don't use sprites, entities visual and colliders are the same
+    const auto& ship_pieces = _ship->get_convex_pieces_in_world();
 
-    for (auto& hb:_homing_bullets) {
-        const auto target_index = hb.get_target_index();
-        if (target_index>=0 && target_index<static_cast<int>(_asteroids.size())) {
-            hb.set_target_pos(_asteroids[target_index].get_world_pos());
-            _asteroids[target_index].set_color({1.0f, 0.5f, 1.0f, 1.0f});
+    // ship against collectibles
+    {
+        _collider_tree.query(_ship->get_bounds().aabb, _candidates);
+        for (const auto user:_candidates) {
+            if (collider_kind(user) != Collider_Kind::COLLECTIBLE) continue;
+
+            const auto index = collider_index(user);
+            const auto& c = _entities.get<Collectibles>().get<peria::Collider>()[index];
+            const auto picked = peria::narrowphase(c.bounds, _ship->get_bounds(), _narrowphase_stats, [&]() {
+                const auto& [pos, size] = c.bounds.aabb;
+                const std::array<glm::vec2, 4> collectibe_poly{{
+                    {pos.x, pos.y},
+                    {pos.x+size.x, pos.y},
+                    {pos.x+size.x, pos.y-size.y},
+                    {pos.x, pos.y-size.y}
+                }};
+                return peria::concave_overlap(_narrowphase_policy.collectible_ship, collectibe_poly, peria::AXIS_ALIGNED_AXES, ship_pieces);
+            });
+            if (picked) _collision_events.push_back({index, 0, Collision_Kind::SHIP_COLLECTIBLE});
         }
-        hb.update(dt);
     }
 
-    // stores asteroids from potential split
-    // which later are moved into _asteroids member
-    std::vector<Asteroid> new_asteroids;
-    new_asteroids.reserve(32);
+    // ship against asteroids
+    if (!_ship->is_invincible()) {
+        _collider_tree.query(_ship->get_bounds().aabb, _candidates);
+        for (const auto user:_candidates) {
+            if (collider_kind(user) != Collider_Kind::ASTEROID) continue;
+
+            const auto index = collider_index(user);
+            const auto& a = _asteroids[index];
+            if (peria::narrowphase(_ship->get_bounds(), a.get_bounds(), _narrowphase_stats, [&]() {
+                    return peria::concave_overlap(_narrowphase_policy.ship_asteroid, ship_pieces, a.get_convex_pieces_in_world());
+                })) {
+                _collision_events.push_back({index, 0, Collision_Kind::SHIP_ASTEROID});
+                // ship is invincible after hit, other asteroids touching it don't count
+                break;
+            }
+        }
+    }
 
-    // helper lambda for collectibles
+    // bullets against asteroids, only earliest hit of every bullet counts.
+    // bullets are swept from previous to current position, so fast bullets (or low tick rate)
+    // can't tunnel through asteroids. asteroids are tested at their end of tick pose,
+    // they move slowly compared to bullets.
+    {
+        const auto bullets_len = static_cast<uint32_t>(_bullets.size());
+        const auto& homing = _entities.get<Homing_Bullets>();
+        _bullet_hits.assign(bullets_len + homing.size(), Bullet_Hit{});
+
+        // gather pairs on main thread, tree query is cheap compared to sat
+        _sweep_pairs.clear();
+        auto gather = [&](uint32_t id, const auto& b) {
+            _collider_tree.query(b.get_bounds().aabb, _candidates);
+
+            std::size_t tested{};
+            for (const auto user:_candidates) {
+                if (collider_kind(user) != Collider_Kind::ASTEROID) continue;
+                ++tested;
+                _sweep_pairs.push_back({id, collider_index(user), false, false, {}});
+            }
+            _broadphase_stats.pairs_tested += tested;
+            _broadphase_stats.pairs_culled += _asteroids.size() - tested;
+        };
+
+        for (uint32_t i{}; i<bullets_len; ++i) {
+            gather(i, _bullets[i]);
+        }
+        for (uint32_t i{}; i<homing.size(); ++i) {
+            gather(bullets_len+i, Homing_Bullet{homing, i});
+        }
+
+        // narrowphase only reads entities and sat cache, every job writes its own pairs
+        // and stats of its thread, so nothing is shared
+        std::fill(_thread_stats.begin(), _thread_stats.end(), peria::Narrowphase_Stats{});
+        _jobs.parallel_for(_sweep_pairs.size(), SWEEP_CHUNK, [&](std::size_t begin, std::size_t end, std::size_t thread) {
+            peria::Narrowphase_Stats stats;
+            auto sweep = [&](Sweep_Pair& p, const auto& b) {
+                const auto& a = _asteroids[p.asteroid];
+                p.tested = false;
+                p.hit = peria::narrowphase(b.get_bounds(), a.get_bounds(), stats, [&]() {
+                    p.tested = true;
+                    p.result = _sat_cache.sweep_test(a.get_id(), b.get_id(), b.get_prev_world_points(), peria::AXIS_ALIGNED_AXES, b.get_displacement(), a.get_convex_pieces_in_world());
+                    return p.result.toi.has_value();
+                });
+            };
+
+            for (auto i=begin; i<end; ++i) {
+                auto& p = _sweep_pairs[i];
+                if (p.bullet < bullets_len) sweep(p, _bullets[p.bullet]);
+                else                        sweep(p, Homing_Bullet{homing, p.bullet-bullets_len});
+            }
+            _thread_stats[thread] += stats;
+        });
+
+        // merge on main thread in gather order, so cache and hits are same as with one thread
+        for (const auto& s:_thread_stats) {
+            _narrowphase_stats += s;
+        }
+        for (const auto& p:_sweep_pairs) {
+            if (!p.tested) continue;
+
+            const auto bullet_entity = p.bullet < bullets_len ? _bullets[p.bullet].get_id() : homing.ids()[p.bullet-bullets_len];
+            _sat_cache.commit(_asteroids[p.asteroid].get_id(), bullet_entity, p.result);
+
+            if (!p.hit) continue;
+
+            // ties go to lower asteroid index, so result doesn't depend on query order
+            auto& best = _bullet_hits[p.bullet];
+            const auto toi = *p.result.toi;
+            if (toi < best.toi || (toi == best.toi && p.asteroid < best.asteroid)) {
+                best = {toi, p.asteroid};
+            }
+        }
+
+        for (uint32_t id{}; id<_bullet_hits.size(); ++id) {
+            if (_bullet_hits[id].asteroid != Bullet_Hit::NONE) {
+                _collision_events.push_back({_bullet_hits[id].asteroid, id, Collision_Kind::BULLET_ASTEROID});
+            }
+        }
+    }
+
+    std::sort(_collision_events.begin(), _collision_events.end());
+}
+
+bool Game::resolve_collisions()
+{
+    // randomly drop collectibles after asteroid explodes
     auto spawn_collectible = [this](const Asteroid& a) {
         auto pos = a.get_world_pos();
         const auto [w, h] = get_world_size();
@@ -583,133 +790,109 @@ void Game::update_playing_state(float dt)
         else if (pos.x > w) pos.x = w - 10.0f;
         if (pos.y < 0.0f)   pos.y = 10.0f;
         else if (pos.y > h) pos.y = h - 10.0f;
+        // pos is top left corner of collectible
+        auto add = [&](Collectible::Collectible_Type type, glm::vec4 color) {
+            const glm::vec2 size{10.0f, 10.0f};
+            const Transform t{{pos.x+size.x*0.5f, pos.y-size.y*0.5f}, size, 0.0f};
+            _entities.get<Collectibles>().create(t, peria::Collider{{t.pos, glm::length(size)*0.5f, {pos, size}}},
+                                                 peria::Health{1}, peria::Renderable{color}, Collectible{type});
+        };
         if (peria::get_int(1, 15) == 8 && _unlocked_weapons[static_cast<int>(Active_Weapon::SHOTGUN)]) {
-            _gun_collectibles.emplace_back(Collectible::Collectible_Type::SHOTGUN, pos, glm::vec2{10.0f, 10.0f});
+            add(Collectible::Collectible_Type::SHOTGUN, {1.0f, 1.0f, 0.0f, 1.0f});
         }
         else if (peria::get_int(1, 15) == 8 && _unlocked_weapons[static_cast<int>(Active_Weapon::HOMING_GUN)]) {
-            _gun_collectibles.emplace_back(Collectible::Collectible_Type::HOMING_GUN, pos, glm::vec2{10.0f, 10.0f});
+            add(Collectible::Collectible_Type::HOMING_GUN, {0.4f, 1.0f, 0.4f, 1.0f});
         }
     };
 
-    // check collisions between asteroids and other entities
-    {
-        for (auto& a:_asteroids) {
-            const peria::Polygon asteroid_poly{a.get_points_in_world()};
-
-            if (!_ship->is_invincible()) {
-                if (concave_sat(ship_poly, asteroid_poly)) {
-                    _ship->hit();
-                    if (_ship->hp() == 0) {
-                        // update stats
-                        update_stats();
-                        _state = Game_State::DEAD;
-                        return;
-                    }
+    const auto bullets_len = static_cast<uint32_t>(_bullets.size());
+    for (const auto& e:_collision_events) {
+        switch (e.kind) {
+            case Collision_Kind::SHIP_COLLECTIBLE: {
+                auto& collectibles = _entities.get<Collectibles>();
+                switch (collectibles.get<Collectible>()[e.a].type) {
+                    case Collectible::Collectible_Type::SHOTGUN:
+                        _active_weapon = Active_Weapon::SHOTGUN;
+                        _shotgun.reset();
+                        break;
+                    case Collectible::Collectible_Type::HOMING_GUN:
+                        _active_weapon = Active_Weapon::HOMING_GUN;
+                        _homing_gun.reset();
+                        break;
+                    default:
+                        break;
                 }
+                collectibles.get<peria::Health>()[e.a].hp = 0; // taken
+                break;
             }
+            case Collision_Kind::SHIP_ASTEROID:
+                // at most one per tick, ship touching several asteroids loses one hp
+                PERIA_ASSERT(!_ship->is_invincible(), "ship hit twice in one tick");
+                _ship->hit();
+                if (_ship->hp() == 0) {
+                    // update stats
+                    update_stats();
+                    _state = Game_State::DEAD;
+                    return false;
+                }
+                break;
+            case Collision_Kind::BULLET_ASTEROID: {
+                auto a = _asteroids[e.a];
+                if (a.dead()) break; // bullet flies on, same as when asteroid died earlier in tick
 
-            for (auto& b:_bullets) {
-                if (a.dead()) continue;
-                
-                peria::Polygon bullet_poly{b.get_world_points()};
-                if (concave_sat(bullet_poly, asteroid_poly)) {
-                    b.explode();
+                if (e.b < bullets_len) {
+                    _bullets.explode(e.b);
                     a.hit(); // deal damage
-                    if (a.hp() == 0) {
-                        a.explode();
-                        // randomly drop collectibles after asteroid explodes
-                        spawn_collectible(a);
-                        auto asteroids = a.split(); // vector of 0, 3 or 6 asteroids
-                        // move temporary smaller asteroids into new_asteroids
-                        if (!asteroids.empty()) {
-                            for (auto& tmp:asteroids) {
-                                new_asteroids.emplace_back(std::move(tmp));
-                            }
-                        }
-                    }
                 }
-            }
-
-            for (auto& hb:_homing_bullets) {
-                if (a.dead()) continue;
-                
-                peria::Polygon bullet_poly{hb.get_world_points()};
-                if (concave_sat(bullet_poly, asteroid_poly)) {
-                    hb.explode();
-                    const auto hb_damage = hb.get_damage();
+                else {
+                    _entities.get<Homing_Bullets>().get<peria::Health>()[e.b-bullets_len].hp = 0;
+                    const auto hb_damage = Homing_Bullet::get_damage();
                     for (uint8_t i{}; i<hb_damage; ++i) 
                         a.hit(); // deal damage
-                    if (a.hp() == 0) {
-                        a.explode();
-                        // randomly drop collectibles after asteroid explodes
-                        spawn_collectible(a);
-                        auto asteroids = a.split(); // vector of 0 or 3 or 6 asteroids
-                        // move temporary smaller asteroids into new_asteroids
-                        if (!asteroids.empty()) {
-                            for (auto& tmp:asteroids) {
-                                new_asteroids.emplace_back(std::move(tmp));
-                            }
-                        }
-                    }
                 }
-            }
-        }
-    }
-    
-    _bullets.erase(std::remove_if(_bullets.begin(), _bullets.end(), 
-                   [](const Bullet& b) { return b.dead(); }),
-                   _bullets.end());
-
-    // before erasing dead asteroids check 2 scenarios:
-    // 1) homing bullets target asteroid was exploded by other bullet
-    //    in previous frame. In this case unset hb target and let it continue flying
-    //    in last direction it was flying.
-    // 2) homing bullet is targeting asteroid x, in prev frame another bullet killed
-    //    some other asteroid y. If Index of y < Index of x, after vector.erase()
-    //    hb target will point to invalid asteroid, or even could be out of bounds.
-    //    So offset all the prev target indices that are effected by resize.
-    {
-        // each i-th elem stores number of dead asteroids in that prefix 
-        // NOTE: using 1-based indexing here
-        std::vector<int> pref_dead_asteroids(_asteroids.size()+1, 0);
-
-        for (std::size_t i{}; i<_asteroids.size(); ++i) {
-            if (_asteroids[i].dead()) pref_dead_asteroids[i+1] = 1;
-            pref_dead_asteroids[i+1] += pref_dead_asteroids[i];
-        }
 
-        for (std::size_t i{}; i<_homing_bullets.size(); ++i) {
-            auto& hb = _homing_bullets[i];
-            if (const auto target_index = hb.get_target_index(); 
-                target_index>=0 && target_index<static_cast<int>(_asteroids.size())) {
-                if (_asteroids[target_index].dead() && !hb.dead()) { // case 1
-                    hb.set_target_index(-1);
-                }
-                else { // case 2
-                    hb.set_target_index(target_index - pref_dead_asteroids[target_index+1]); // +1 because pref indexing is 1-based
+                if (a.hp() == 0) {
+                    a.explode();
+                    spawn_collectible(a);
+                    // 0, 3 or 6 children are built at end of _asteroids, which has room for them.
+                    // they join collider tree in next tick
+                    (void)_asteroids.split(e.a);
                 }
+                break;
             }
         }
     }
+    return true;
+}
 
-    _asteroids.erase(std::remove_if(_asteroids.begin(), _asteroids.end(), 
-                   [](const Asteroid& a) { return a.dead(); }),
-                   _asteroids.end());
+void Game::sync_collider_tree()
+{
+    // fat bounds absorb small moves, so most ticks only refresh user values
+    auto sync = [this](peria::Aabb_Tree::Proxy& proxy, const peria::AABB_Collider& bounds, uint32_t user) {
+        if (proxy == peria::Aabb_Tree::NONE) {
+            proxy = _collider_tree.insert(bounds, user);
+        }
+        else {
+            _collider_tree.move(proxy, bounds);
+            _collider_tree.set_user(proxy, user);
+        }
+    };
 
-    _homing_bullets.erase(std::remove_if(_homing_bullets.begin(), _homing_bullets.end(), 
-                   [](const Homing_Bullet& hb) { return hb.dead(); }),
-                   _homing_bullets.end());
+    // new asteroids (level start, children of split) get their proxy and handle on their first tick
+    for (uint32_t i{}; i<_asteroids.size(); ++i) {
+        auto a = _asteroids[i];
+        auto proxy = a.get_broadphase_proxy();
+        sync(proxy, a.get_bounds().aabb, collider_user(Collider_Kind::ASTEROID, i));
+        a.set_broadphase_proxy(proxy);
 
-    for (auto& a:new_asteroids) {
-        _asteroids.emplace_back(std::move(a));
+        if (a.get_handle().valid()) _asteroid_handles.relocate(a.get_handle(), i);
+        else                        a.set_handle(_asteroid_handles.acquire(i));
     }
-
-    if (_asteroids.empty()) {
-        ++_upgrade_count;
-        current_stats.total_time += current_time;
-        ++current_stats.level_count;
-        _state = Game_State::WON;
+    const auto collectibles = _entities.get<Collectibles>().get<peria::Collider>();
+    for (uint32_t i{}; i<collectibles.size(); ++i) {
+        sync(collectibles[i].proxy, collectibles[i].bounds.aabb, collider_user(Collider_Kind::COLLECTIBLE, i));
     }
+    sync(_ship_proxy, _ship->get_bounds().aabb, collider_user(Collider_Kind::SHIP, 0));
 }
 
 void Game::update_paused_state()
@@ -934,9 +1117,15 @@ void Game::reset_state()
     _ship->restart();
     
     _asteroids.clear();
+    _collider_pool.release();
+    _collider_arena.reset();
+    _asteroid_handles.clear();
+    _target = {};
+    _collider_tree.clear();
+    _sat_cache.clear();
+    _ship_proxy = peria::Aabb_Tree::NONE;
     _bullets.clear();
-    _homing_bullets.clear();
-    _gun_collectibles.clear();
+    _entities.clear();
     _active_weapon = Active_Weapon::GUN;
     _gun.reset();
     current_time = 0.0f;
@@ -945,69 +1134,81 @@ void Game::reset_state()
 void Game::init_level1()
 {
     reset_state();
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE, 
-                            glm::vec2{350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 1);
-
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE,
-                            glm::vec2{get_world_size().x-350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))},   1);
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE, 
+                     glm::vec2{350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 1);
+
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE,
+                     glm::vec2{get_world_size().x-350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))},   1);
+    reserve_split_trees();
 }
 
 void Game::init_level2()
 {
     reset_state();
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE, 
-                            glm::vec2{350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))},   2);
-
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE,
-                            glm::vec2{get_world_size().x-350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 2);
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE, 
+                     glm::vec2{350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))},   2);
+
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE,
+                     glm::vec2{get_world_size().x-350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 2);
+    reserve_split_trees();
 }
 
 void Game::init_level3()
 {
     reset_state();
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE, 
-                            glm::vec2{350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 3);
-
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE,
-                            glm::vec2{get_world_size().x-350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 3);
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE, 
+                     glm::vec2{350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 3);
+
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE,
+                     glm::vec2{get_world_size().x-350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 3);
+    reserve_split_trees();
 }
 
 void Game::init_level4()
 {
     reset_state();
     const auto [w, h] = get_world_size();
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE, 
-                            glm::vec2{350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 4);
-
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE,
-                            glm::vec2{get_world_size().x-350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 4);
-
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE,
-                            glm::vec2{w*0.5f, h*0.5f-300.0f},
-                            _ship->get_direction_vector(), 4);
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE, 
+                     glm::vec2{350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 4);
+
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE,
+                     glm::vec2{get_world_size().x-350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 4);
+
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE,
+                     glm::vec2{w*0.5f, h*0.5f-300.0f},
+                     _ship->get_direction_vector(), 4);
+    reserve_split_trees();
 }
 
 void Game::init_level5()
 {
     reset_state();
     const auto [w, h] = get_world_size();
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE, 
-                            glm::vec2{350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 5);
-
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE,
-                            glm::vec2{get_world_size().x-350.0f, 600.0f},
-                            glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 5);
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE, 
+                     glm::vec2{350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(-30.0f)), std::sin(glm::radians(-30.0f))}, 5);
+
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE,
+                     glm::vec2{get_world_size().x-350.0f, 600.0f},
+                     glm::vec2{std::cos(glm::radians(210.0f)), std::sin(glm::radians(210.0f))}, 5);
+
+    _asteroids.spawn(Asteroid::Asteroid_Type::LARGE,
+                     glm::vec2{w*0.5f, h*0.5f-300.0f},
+                     _ship->get_direction_vector(), 5);
+    reserve_split_trees();
+}
 
-    _asteroids.emplace_back(Asteroid::Asteroid_Type::LARGE,
-                            glm::vec2{w*0.5f, h*0.5f-300.0f},
-                            _ship->get_direction_vector(), 5);
+void Game::reserve_split_trees()
+{
+    std::size_t worst_case{};
+    for (const auto& a:_asteroids) worst_case += Asteroid::split_tree_size(a.get_type());
+    _asteroids.reserve(worst_case);
 }
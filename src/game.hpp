@@ -2,19 +2,35 @@
 
 #include <functional>
 #include <memory>
+#include <memory_resource>
+#include <tuple>
 #include <vector>
 #include <array>
+#include <limits>
+#include <utility>
 
 #include "asteroid.hpp"
+#include "bullet.hpp"
+#include "components.hpp"
+#include "ecs.hpp"
+#include "homing_bullet.hpp"
 #include "weapons.hpp"
 #include "button.hpp"
+#include "broadphase.hpp"
+#include "aabb_tree.hpp"
+#include "alloc_counter.hpp"
+#include "frame_arena.hpp"
+#include "frame_pacer.hpp"
+#include "handle_pool.hpp"
+#include "sat_cache.hpp"
+#include "job_system.hpp"
+#include "gjk.hpp"
+#include "vertex_batch.hpp"
 
 class Graphics;
 class Input_Manager;
 class Ship;
 class Asteroid;
-class Bullet;
-class Homing_Bullet;
 
 class Game {
 public:
@@ -27,22 +43,21 @@ public:
         DEBUG_HELPER
     };
 
+    // weapon given to ship that picks collectible up
     struct Collectible {
         enum class Collectible_Type {
             SHOTGUN,
             HOMING_GUN
         };
-        Collectible() = default;
-        Collectible(Collectible_Type type_, const glm::vec2& pos_, const glm::vec2& size_)
-            :type{type_}, pos{pos_}, size{size_}
-        {}
-
         Collectible_Type type;
-        glm::vec2 pos;
-        glm::vec2 size;
-        bool taken{false};
     };
 
+    // collectibles don't move, hp drops to 0 when taken
+    using Collectibles = peria::Archetype<Transform, peria::Collider, peria::Health, peria::Renderable, Collectible>;
+
+    // entities stored by component, see ecs.hpp. asteroids, ship and gun bullets have their own storage
+    using Entities = peria::World<Homing_Bullets, Collectibles>;
+
     struct World_Size {
         float x;
         float y;
@@ -53,6 +68,13 @@ public:
     
     void run();
 
+    // fixed simulation rate, bullets are swept so lower rates don't miss hits.
+    // hz in [MIN_TICK_RATE, MAX_TICK_RATE], callers validate user input
+    void set_tick_rate(float hz);
+
+    static constexpr float MIN_TICK_RATE = 10.0f;
+    static constexpr float MAX_TICK_RATE = 1000.0f;
+
     [[nodiscard]]
     static World_Size get_world_size()
     { return {1600.0f, 900.0f}; }
@@ -69,6 +91,20 @@ private:
 
     void update_stats();
 
+    // inserts new entities into _collider_tree and moves existing ones
+    void sync_collider_tree();
+
+    // temporaries of previous step are dropped and arena is reused from start
+    void reset_tick_arena();
+
+    // Narrowphase of the tick, fills sorted _collision_events.
+    // Only reads entities (writes sat cache and stats), so it can be moved or split freely.
+    void detect_collisions();
+
+    // applies game rules to _collision_events in order, false if ship died
+    [[nodiscard]]
+    bool resolve_collisions();
+
     void reset_state();
     void full_reset_on_dead_state();
 
@@ -77,6 +113,10 @@ private:
     void init_level3();
     void init_level4();
     void init_level5();
+
+    // reserves _asteroids for every asteroid the level can ever have, see Asteroid::split_tree_size
+    void reserve_split_trees();
+
 private:
     enum class Active_Weapon {
         GUN = 0,
@@ -100,10 +140,21 @@ private:
     Input_Manager& _input_manager;
     
     std::unique_ptr<Ship> _ship;
-    std::vector<Asteroid> _asteroids;
+    // World space collider pieces of asteroids. Pieces of dead asteroids go back to pool
+    // and children of split ones take them, arena is reset with level. Declared before
+    // _asteroids, so asteroids give their pieces back before pool is destroyed.
+    peria::Frame_Arena _collider_arena{512*1024};
+    std::pmr::unsynchronized_pool_resource _collider_pool{_collider_arena.resource()};
+
+    // Temporaries of one fixed step: bullet hits, sweep pairs, collision events and dead ids.
+    // Reset at start of every 'update_playing_state', see 'reset_tick_arena'.
+    peria::Frame_Arena _tick_arena{256*1024};
+
+    // capacity is reserved for whole split tree of level, split builds children in place
+    Asteroid_Pool _asteroids{&_collider_pool};
 
-    std::vector<Bullet> _bullets;
-    std::vector<Homing_Bullet> _homing_bullets;
+    Bullet_Pool _bullets; // gun and shotgun bullets, indices change when dead ones are removed
+    Entities _entities; // rows change when dead ones are removed
 
     Gun _gun;
     Shotgun _shotgun;
@@ -111,9 +162,12 @@ private:
 
     Active_Weapon _active_weapon;
 
-    std::vector<Collectible> _gun_collectibles;
+    peria::Handle _target{}; // asteroid locked by homing gun while space is held
 
-    int _target_index{-1};
+    // Handles of _asteroids, homing bullets keep them instead of indices.
+    // Released when asteroid is erased, relocated in 'sync_collider_tree' (vector shifts
+    // only after that in tick, and nothing resolves handles between erase and next sync).
+    peria::Handle_Pool _asteroid_handles;
 
     std::size_t _level_id;
     std::vector<std::function<void()>> _level_init_calls;
@@ -129,6 +183,94 @@ private:
     uint8_t _upgrade_count{0};
     std::array<bool, 3> _unlocked_weapons;
 
+    // user value of proxies in _collider_tree.
+    // kind is in top bits, index into vector of that kind in the rest
+    enum class Collider_Kind : uint32_t {
+        ASTEROID = 0,
+        COLLECTIBLE,
+        SHIP
+    };
+    static constexpr uint32_t COLLIDER_KIND_SHIFT = 30;
+
+    [[nodiscard]]
+    static uint32_t collider_user(Collider_Kind kind, uint32_t index)
+    { return (static_cast<uint32_t>(kind) << COLLIDER_KIND_SHIFT) | index; }
+
+    [[nodiscard]]
+    static Collider_Kind collider_kind(uint32_t user)
+    { return static_cast<Collider_Kind>(user >> COLLIDER_KIND_SHIFT); }
+
+    [[nodiscard]]
+    static uint32_t collider_index(uint32_t user)
+    { return user & ((1u << COLLIDER_KIND_SHIFT) - 1); }
+
+    // index into _asteroids, -1 for other kinds (homing gun target queries)
+    [[nodiscard]]
+    static int asteroid_index(uint32_t user)
+    { return collider_kind(user) == Collider_Kind::ASTEROID ? static_cast<int>(collider_index(user)) : -1; }
+
+    // broadphase over long lived entities (asteroids, collectibles, ship), queried by bullets and ship.
+    // proxies are stored in entities, user values are refreshed every tick since vectors shift
+    peria::Aabb_Tree _collider_tree;
+    peria::Aabb_Tree::Proxy _ship_proxy{peria::Aabb_Tree::NONE};
+    std::vector<uint32_t> _candidates; // reused query buffer
+    peria::Broadphase_Stats _broadphase_stats;
+    peria::Narrowphase_Stats _narrowphase_stats;
+    peria::Narrowphase_Policy _narrowphase_policy;
+
+    // earliest asteroid hit by bullet during tick.
+    // bullets have ids [0, bullets), homing bullets [bullets, bullets+homing_bullets)
+    struct Bullet_Hit {
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        float toi{std::numeric_limits<float>::max()}; // fraction of tick [0, 1]
+        uint32_t asteroid{NONE};
+    };
+    std::pmr::vector<Bullet_Hit> _bullet_hits{_tick_arena.resource()};
+
+    // Collision found by 'detect_collisions'. Sorted by kind, then a, then b, that is
+    // collectibles are picked before ship takes damage and bullet hits resolve in asteroid order.
+    enum class Collision_Kind : uint8_t {
+        SHIP_COLLECTIBLE = 0, // a - collectible index
+        SHIP_ASTEROID,        // a - asteroid index
+        BULLET_ASTEROID       // a - asteroid index, b - bullet id, see Bullet_Hit
+    };
+    struct Collision_Event {
+        uint32_t a;
+        uint32_t b;
+        Collision_Kind kind;
+
+        [[nodiscard]]
+        bool operator<(const Collision_Event& o) const
+        { return std::tie(kind, a, b) < std::tie(o.kind, o.a, o.b); }
+    };
+    std::pmr::vector<Collision_Event> _collision_events{_tick_arena.resource()};
+
+    // last separating axis of bullet/asteroid pairs, keyed by entity ids
+    peria::Sat_Cache _sat_cache;
+
+    // bullet/asteroid pair left by broadphase, narrowphase fills the rest on job threads
+    struct Sweep_Pair {
+        uint32_t bullet; // bullet id, see Bullet_Hit
+        uint32_t asteroid;
+        bool tested; // false if rejected before sat ran, result is not set then
+        bool hit;
+        peria::Sat_Cache::Sweep_Result result;
+    };
+    static constexpr std::size_t SWEEP_CHUNK = 64; // pairs per job
+    std::pmr::vector<Sweep_Pair> _sweep_pairs{_tick_arena.resource()};
+    std::vector<peria::Narrowphase_Stats> _thread_stats; // one per job thread
+    peria::Job_System _jobs;
+    std::pmr::vector<uint32_t> _dead_ids{_tick_arena.resource()};
+
+    // world space outlines of asteroids and ship, once per tick for colliders, once per frame for drawing
+    peria::Vertex_Batch _tick_vertices;
+    peria::Vertex_Batch _frame_vertices;
+
+    float _step{1.0f/60.0f};
+
+    peria::Tick_Allocations _tick_allocations;
+    peria::Frame_Pacer _frame_pacer;
+
 public:
     // disable copy move ops
     Game(const Game&) = delete;
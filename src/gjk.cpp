@@ -0,0 +1,193 @@
+#include "gjk.hpp"
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace peria {
+
+namespace {
+
+// polygons have at most 16 vertices, gjk converges in few steps
+constexpr int GJK_MAX_ITERATIONS = 32;
+constexpr int EPA_MAX_ITERATIONS = 32;
+constexpr float EPA_TOLERANCE = 1e-4f;
+
+[[nodiscard]]
+float cross(glm::vec2 a, glm::vec2 b)
+{ return a.x*b.y - a.y*b.x; }
+
+// farthest vertex of polygon in direction d
+[[nodiscard]]
+glm::vec2 support(Polygon_View points, glm::vec2 d)
+{
+    auto best = points[0];
+    auto best_dot = glm::dot(best, d);
+    for (std::size_t i=1; i<points.size(); ++i) {
+        const auto dot = glm::dot(points[i], d);
+        if (dot > best_dot) {
+            best = points[i];
+            best_dot = dot;
+        }
+    }
+    return best;
+}
+
+// farthest point of minkowski difference a - b in direction d
+[[nodiscard]]
+glm::vec2 support(Polygon_View a, Polygon_View b, glm::vec2 d)
+{ return support(a, d) - support(b, -d); }
+
+// normal of segment direction pointing to the same side as 'to'
+[[nodiscard]]
+glm::vec2 normal_towards(glm::vec2 segment, glm::vec2 to)
+{
+    const glm::vec2 n{-segment.y, segment.x};
+    return glm::dot(n, to) < 0.0f ? -n : n;
+}
+
+// newest point is last
+struct Simplex {
+    std::array<glm::vec2, 3> points;
+    std::size_t size{};
+};
+
+// true if minkowski difference contains origin, simplex is left around it
+[[nodiscard]]
+bool run_gjk(Polygon_View a, Polygon_View b, Simplex& s)
+{
+    auto d = a[0] - b[0];
+    if (d == glm::vec2{0.0f}) d = {1.0f, 0.0f};
+
+    s.points[0] = support(a, b, d);
+    s.size = 1;
+    d = -s.points[0];
+
+    for (int i{}; i<GJK_MAX_ITERATIONS; ++i) {
+        if (d == glm::vec2{0.0f}) return true; // origin lies on simplex, polygons touch
+
+        const auto p = support(a, b, d);
+        if (glm::dot(p, d) < 0.0f) return false; // origin is beyond farthest point
+        s.points[s.size++] = p;
+
+        if (s.size == 2) {
+            const auto ab = s.points[0] - p;
+            const auto ao = -p;
+            if (glm::dot(ab, ao) > 0.0f) {
+                if (cross(ab, ao) == 0.0f) return true;
+                d = normal_towards(ab, ao);
+            }
+            else {
+                s.points[0] = p;
+                s.size = 1;
+                d = ao;
+            }
+            continue;
+        }
+
+        // triangle, drop vertex that is farther from origin than the edge facing it
+        const auto ab = s.points[1] - p;
+        const auto ac = s.points[0] - p;
+        const auto ao = -p;
+        const auto ab_normal = -normal_towards(ab, ac);
+        const auto ac_normal = -normal_towards(ac, ab);
+        if (glm::dot(ab_normal, ao) > 0.0f) {
+            s.points = {s.points[1], p, {}};
+            s.size = 2;
+            d = ab_normal;
+        }
+        else if (glm::dot(ac_normal, ao) > 0.0f) {
+            s.points = {s.points[0], p, {}};
+            s.size = 2;
+            d = ac_normal;
+        }
+        else {
+            return true;
+        }
+    }
+    // cycling on boundary, polygons (almost) touch
+    return true;
+}
+
+}
+
+bool gjk(Polygon_View a, Polygon_View b)
+{
+    Simplex s;
+    return run_gjk(a, b, s);
+}
+
+std::optional<Penetration> gjk_epa(Polygon_View a, Polygon_View b)
+{
+    Simplex s;
+    if (!run_gjk(a, b, s)) return std::nullopt;
+
+    // gjk stopped early on touching polygons, grow simplex into triangle
+    if (s.size == 1) {
+        return Penetration{{1.0f, 0.0f}, 0.0f};
+    }
+    if (s.size == 2) {
+        const auto segment = s.points[1] - s.points[0];
+        const auto n = glm::vec2{-segment.y, segment.x};
+        auto p = support(a, b, n);
+        if (glm::dot(p - s.points[0], n) <= 0.0f) p = support(a, b, -n);
+        if (cross(segment, p - s.points[0]) == 0.0f) {
+            // minkowski difference is flat
+            return Penetration{glm::normalize(n), 0.0f};
+        }
+        s.points[2] = p;
+        s.size = 3;
+    }
+
+    // polytope kept counter clockwise, so edge normal (y, -x) points outside.
+    // every iteration adds one vertex, so array never overflows
+    std::array<glm::vec2, 3 + EPA_MAX_ITERATIONS> polytope{s.points[0], s.points[1], s.points[2]};
+    std::size_t size = 3;
+    if (cross(polytope[1] - polytope[0], polytope[2] - polytope[0]) < 0.0f) std::swap(polytope[1], polytope[2]);
+
+    Penetration res{};
+    for (int iteration{}; iteration<EPA_MAX_ITERATIONS; ++iteration) {
+        // edge closest to origin
+        std::size_t closest{};
+        res.depth = std::numeric_limits<float>::max();
+        for (std::size_t i{}; i<size; ++i) {
+            const auto edge = polytope[(i+1)%size] - polytope[i];
+            const auto n = glm::normalize(glm::vec2{edge.y, -edge.x});
+            const auto distance = glm::dot(n, polytope[i]);
+            if (distance < res.depth) {
+                res = {n, distance};
+                closest = i;
+            }
+        }
+
+        const auto p = support(a, b, res.normal);
+        if (glm::dot(p, res.normal) - res.depth < EPA_TOLERANCE) break;
+
+        // split closest edge by new point
+        for (auto i=size; i>closest+1; --i) polytope[i] = polytope[i-1];
+        polytope[closest+1] = p;
+        ++size;
+    }
+    // outside normal of a - b points from a to b
+    return res;
+}
+
+bool concave_gjk(std::span<const Small_Polygon> a_pieces, std::span<const Small_Polygon> b_pieces)
+{
+    for (const auto& part_a:a_pieces) {
+        for (const auto& part_b:b_pieces) {
+            if (gjk(part_a, part_b)) return true;
+        }
+    }
+    return false;
+}
+
+bool concave_gjk(Polygon_View convex, std::span<const Small_Polygon> pieces)
+{
+    for (const auto& piece:pieces) {
+        if (gjk(convex, piece)) return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "physics.hpp"
+
+namespace peria {
+
+// how deep two convex polygons overlap.
+// moving b by normal*depth (or a by -normal*depth) leaves them touching.
+struct Penetration {
+    glm::vec2 normal; // unit, points from a to b
+    float depth;
+};
+
+// Check if two convex polygons intersect with Gilbert-Johnson-Keerthi algorithm.
+// Only support points (farthest vertex in direction) are needed, so unlike 'sat()'
+// cost doesn't grow with number of edges, just with number of vertices scanned.
+// Touching polygons intersect, same as in 'sat()'.
+[[nodiscard]]
+bool gjk(Polygon_View a, Polygon_View b);
+
+// gjk() followed by expanding polytope algorithm (EPA) for penetration depth,
+// nothing if polygons don't intersect
+[[nodiscard]]
+std::optional<Penetration> gjk_epa(Polygon_View a, Polygon_View b);
+
+// same as concave_sat(), with gjk() on every pair of pieces
+[[nodiscard]]
+bool concave_gjk(std::span<const Small_Polygon> a_pieces, std::span<const Small_Polygon> b_pieces);
+
+[[nodiscard]]
+bool concave_gjk(Polygon_View convex, std::span<const Small_Polygon> pieces);
+
+enum class Overlap_Algorithm : uint8_t {
+    SAT = 0,
+    GJK
+};
+
+// Overlap test used for each pair of shape classes game tests, see "gjk" benchmark.
+// Bullets against asteroids always use swept SAT, they need time of impact.
+// SAT wins every class with precomputed axes (about 2x), GJK is there for shapes without them.
+struct Narrowphase_Policy {
+    Overlap_Algorithm ship_asteroid{Overlap_Algorithm::SAT};
+    Overlap_Algorithm collectible_ship{Overlap_Algorithm::SAT};
+};
+
+// concave_sat() or concave_gjk()
+[[nodiscard]]
+inline
+bool concave_overlap(Overlap_Algorithm algorithm, std::span<const Small_Polygon> a_pieces, std::span<const Small_Polygon> b_pieces)
+{ return algorithm == Overlap_Algorithm::GJK ? concave_gjk(a_pieces, b_pieces) : concave_sat(a_pieces, b_pieces); }
+
+// convex_axes are used only by SAT
+[[nodiscard]]
+inline
+bool concave_overlap(Overlap_Algorithm algorithm, Polygon_View convex, Axes_View convex_axes, std::span<const Small_Polygon> pieces)
+{ return algorithm == Overlap_Algorithm::GJK ? concave_gjk(convex, pieces) : concave_sat(convex, convex_axes, pieces); }
+
+}
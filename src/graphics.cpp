@@ -478,12 +478,14 @@ void Graphics::draw_line(glm::vec2 p1, glm::vec2 p2, glm::vec4 color)
 }
 
 // poly_points in world space
-void Graphics::draw_polygon(const std::vector<glm::vec2>& poly_points, glm::vec4 color)
+void Graphics::draw_polygon(std::span<const glm::vec2> poly_points, glm::vec4 color)
 {
     PERIA_ASSERT(poly_points.size() >= 3, "poly must have at least 3 points");
-    auto tris = peria::Polygon{poly_points}.triangulate(true);
-    for (auto&& t:tris) {
-        draw_triangle(t.points()[0], t.points()[1], t.points()[2], color);
+    _polygon_arena.reset();
+    std::pmr::vector<peria::Triangle> tris{_polygon_arena.resource()};
+    peria::triangulate(poly_points, tris);
+    for (const auto& t:tris) {
+        draw_triangle(t[0], t[1], t[2], color);
     }
 }
 
@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include <array>
+#include <span>
 
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
@@ -13,6 +14,7 @@
 
 #include "vertex_buffer.hpp"
 #include "framebuffer.hpp"
+#include "frame_arena.hpp"
 
 // forward declare
 typedef struct SDL_Window SDL_Window;
@@ -121,7 +123,7 @@ public:
                                                                                    
     void draw_rect(glm::vec2 pos, glm::vec2 size, glm::vec4 color);
 
-    void draw_polygon(const std::vector<glm::vec2>& poly_points, glm::vec4 color);
+    void draw_polygon(std::span<const glm::vec2> poly_points, glm::vec4 color);
 
     void draw_circle(glm::vec2 center, float radius, glm::vec4 color);
 
@@ -189,6 +191,9 @@ private:
     std::unique_ptr<Vertex_Array> _screen_vao;
     std::unique_ptr<Vertex_Buffer<Screen_Vertex>> _screen_vbo;
 
+    // triangles of polygon in 'draw_polygon', reset on every call
+    peria::Frame_Arena _polygon_arena{16*1024};
+
     void init_circle_batch_data();
     void init_triangle_batch_data();
     void init_rect_batch_data();
@@ -0,0 +1,53 @@
+#include "handle_pool.hpp"
+
+#include <cstdlib>
+
+#include "opengl_errors.hpp"
+
+namespace peria {
+
+Handle Handle_Pool::acquire(uint32_t index)
+{
+    PERIA_ASSERT(index != Handle::NONE, "Handle_Pool index is reserved for free slots");
+    if (_free_list == Handle::NONE) {
+        _slots.push_back({Handle::NONE, 0, Handle::NONE});
+        _free_list = static_cast<uint32_t>(_slots.size()-1);
+    }
+
+    const auto slot = _free_list;
+    auto& s = _slots[slot];
+    _free_list = s.next_free;
+    s.index = index;
+    s.next_free = Handle::NONE;
+    ++_alive;
+    return {slot, s.generation};
+}
+
+void Handle_Pool::release(Handle h)
+{
+    if (!alive(h)) return;
+
+    auto& s = _slots[h.slot];
+    s.index = Handle::NONE;
+    ++s.generation;
+    s.next_free = _free_list;
+    _free_list = h.slot;
+    --_alive;
+}
+
+void Handle_Pool::clear()
+{
+    _free_list = Handle::NONE;
+    for (auto i = static_cast<uint32_t>(_slots.size()); i-- > 0;) {
+        auto& s = _slots[i];
+        if (s.index != Handle::NONE) {
+            s.index = Handle::NONE;
+            ++s.generation;
+        }
+        s.next_free = _free_list;
+        _free_list = i;
+    }
+    _alive = 0;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace peria {
+
+// Generational handle to entity stored in some vector, see Handle_Pool.
+// Unlike index it stays correct when vector is compacted or sorted, and
+// unlike entity id it resolves to entity in O(1).
+struct Handle {
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    uint32_t slot{NONE};
+    uint32_t generation{};
+
+    // handle was set, 'Handle_Pool::resolve' tells if entity is still alive
+    [[nodiscard]]
+    bool valid() const
+    { return slot != NONE; }
+
+    bool operator==(const Handle&) const = default;
+};
+
+// Slots map handles to current index of entity in its vector.
+// Owner acquires handle for new entity, relocates it whenever entity moves and releases it
+// when entity dies. Release bumps generation of slot, so all copies of handle stop resolving
+// and slot can be reused. Freed slots are reused, so pool doesn't grow past peak entity count.
+class Handle_Pool {
+public:
+    [[nodiscard]]
+    Handle acquire(uint32_t index);
+
+    void release(Handle h);
+
+    void relocate(Handle h, uint32_t index)
+    { if (alive(h)) _slots[h.slot].index = index; }
+
+    [[nodiscard]]
+    bool alive(Handle h) const
+    { return h.slot < _slots.size() && _slots[h.slot].generation == h.generation && _slots[h.slot].index != Handle::NONE; }
+
+    // index of entity, Handle::NONE if it died (or handle was never set)
+    [[nodiscard]]
+    uint32_t resolve(Handle h) const
+    { return alive(h) ? _slots[h.slot].index : Handle::NONE; }
+
+    // releases every handle, keeps slots
+    void clear();
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _alive; }
+
+private:
+    struct Slot {
+        uint32_t index; // Handle::NONE while slot is free
+        uint32_t generation;
+        uint32_t next_free;
+    };
+
+    std::vector<Slot> _slots;
+    uint32_t _free_list{Handle::NONE};
+    std::size_t _alive{};
+};
+
+}
@@ -1,56 +1,86 @@
 #pragma once
 
 #include <glm/vec2.hpp>
-#include <glm/vec4.hpp>
-#include <vector>
-
-#include "transform.hpp"
+#include <array>
+#include <cstdint>
+
+#include "components.hpp"
+#include "ecs.hpp"
+#include "physics.hpp"
+#include "handle_pool.hpp"
+
+// steering state of homing bullet
+struct Homing {
+    peria::Handle target; // asteroid, bullet flies straight once it doesn't resolve
+    glm::vec2 target_pos{};
+};
 
-class Graphics;
-class Asteroid;
+using Homing_Bullets = peria::Archetype<Transform, peria::Prev_Transform, peria::Velocity,
+                                        peria::Collider, peria::Health, peria::Renderable, Homing>;
 
-class Homing_Bullet {
-public:
-    Homing_Bullet() = default;
+// world_pos is center of square, 2*radius is side_length.
+// target is handle of asteroid, bullet steers to position set in its Homing while it is valid
+std::size_t spawn_homing_bullet(Homing_Bullets& bullets, glm::vec2 world_pos, float radius, peria::Handle target,
+                                glm::vec2 initial_direction, float initial_angle);
 
-    // world_pos is center of square, 2*radius is side_length
-    Homing_Bullet(glm::vec2 world_pos, float radius, int target_index, glm::vec2 initial_direction, float initial_angle, glm::vec4 color);
+// turns velocity of bullets with target towards target pos, before peria::Integrate
+struct Steer_Homing {
+    using Query = peria::Query<Transform, peria::Velocity, Homing>;
+    float dt;
 
-    void update(float dt);
+    void operator()(const Transform& t, peria::Velocity& v, const Homing& h) const;
+};
 
-    void set_target_index(int target_index);
-    void set_target_pos(glm::vec2 target_pos);
+// Read only view of one homing bullet, valid until bullets are removed or spawned.
+// Same interface as Bullet, so narrowphase code takes either.
+class Homing_Bullet {
+public:
+    Homing_Bullet(const Homing_Bullets& bullets, std::size_t index)
+        :_bullets{&bullets}, _i{index}
+    {}
 
     static void set_damage(uint8_t dmg);
     static uint8_t get_damage();
 
+    // square in clockwise order, no heap allocation
     [[nodiscard]]
-    int get_target_index() const;
+    std::array<glm::vec2, 4> get_world_points() const;
 
+    // same square at position from previous tick, start of swept collision test
     [[nodiscard]]
-    std::vector<glm::vec2> get_world_points() const;
+    std::array<glm::vec2, 4> get_prev_world_points() const;
 
+    // distance travelled during last tick, zero after wrap since wrap also moves previous transform
     [[nodiscard]]
-    glm::vec2 get_world_pos() const;
+    glm::vec2 get_displacement() const
+    { return transform().pos - _bullets->get<peria::Prev_Transform>()[_i].pos; }
 
     [[nodiscard]]
-    bool dead() const;
+    glm::vec2 get_world_pos() const
+    { return transform().pos; }
 
-    void explode();
+    // bounding circle and aabb of path travelled during last tick
+    [[nodiscard]]
+    const peria::Bounds& get_bounds() const
+    { return _bullets->get<peria::Collider>()[_i].bounds; }
 
-    void draw(Graphics& g, float alpha) const;
-private:
-    Transform _transform;
-    Transform _prev_transform;
+    // stable id, keys per pair caches
+    [[nodiscard]]
+    uint32_t get_id() const
+    { return _bullets->ids()[_i]; }
 
-    glm::vec2 _dir_vector;
-    glm::vec4 _color;
+    [[nodiscard]]
+    bool dead() const
+    { return _bullets->get<peria::Health>()[_i].hp == 0; }
 
-    int _target_index;
-    glm::vec2 _target_pos;
+private:
+    [[nodiscard]]
+    const Transform& transform() const
+    { return _bullets->get<Transform>()[_i]; }
 
+private:
     static uint8_t _damage;
 
-    bool _dead;
-    float _timer{0.0f};
+    const Homing_Bullets* _bullets;
+    std::size_t _i;
 };
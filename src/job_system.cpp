@@ -0,0 +1,122 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+
+namespace peria {
+
+std::size_t Job_System::default_worker_count()
+{
+    const auto hw = std::thread::hardware_concurrency();
+    return hw > 1 ? hw-1 : 0;
+}
+
+Job_System::Job_System(std::size_t worker_count)
+{
+    for (std::size_t i{}; i<worker_count+1; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    _workers.reserve(worker_count);
+    for (std::size_t i{}; i<worker_count; ++i) {
+        _workers.emplace_back(&Job_System::worker_loop, this, i+1);
+    }
+}
+
+Job_System::~Job_System()
+{
+    {
+        std::lock_guard lock{_wake_mutex};
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& w:_workers) w.join();
+}
+
+void Job_System::run(Task task, void* context, std::size_t count, std::size_t chunk_size)
+{
+    if (count == 0) return;
+    chunk_size = std::max<std::size_t>(chunk_size, 1);
+
+    // nobody to share with, skip queues
+    if (_workers.empty()) {
+        for (std::size_t begin{}; begin<count; begin+=chunk_size) {
+            task(context, begin, std::min(begin+chunk_size, count), 0);
+        }
+        return;
+    }
+
+    const auto chunks = (count+chunk_size-1) / chunk_size;
+    _task = task;
+    _context = context;
+    _pending.store(chunks, std::memory_order_relaxed);
+
+    // task is published by queue mutex, thread reads it only after popping a chunk
+    for (std::size_t q{}; q<_queues.size(); ++q) {
+        auto& queue = *_queues[q];
+        std::lock_guard lock{queue.mutex};
+        queue.ranges.clear();
+        queue.head = 0;
+        for (auto c=q; c<chunks; c+=_queues.size()) {
+            queue.ranges.push_back({c*chunk_size, std::min((c+1)*chunk_size, count)});
+        }
+    }
+
+    {
+        std::lock_guard lock{_wake_mutex};
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    while (execute_one(0)) {}
+
+    // rest of chunks is being finished by workers
+    while (_pending.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+bool Job_System::execute_one(std::size_t thread_index)
+{
+    Range range{};
+    bool found = false;
+
+    {
+        auto& own = *_queues[thread_index];
+        std::lock_guard lock{own.mutex};
+        if (own.head < own.ranges.size()) {
+            range = own.ranges[own.head++];
+            found = true;
+        }
+    }
+
+    for (std::size_t i{1}; !found && i<_queues.size(); ++i) {
+        auto& victim = *_queues[(thread_index+i) % _queues.size()];
+        std::lock_guard lock{victim.mutex};
+        if (victim.head < victim.ranges.size()) {
+            range = victim.ranges.back();
+            victim.ranges.pop_back();
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+
+    _task(_context, range.begin, range.end, thread_index);
+    _pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void Job_System::worker_loop(std::size_t thread_index)
+{
+    uint64_t seen{};
+    while (true) {
+        {
+            std::unique_lock lock{_wake_mutex};
+            _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+            if (_stop) return;
+            seen = _generation;
+        }
+        while (execute_one(thread_index)) {}
+    }
+}
+
+}
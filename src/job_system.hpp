@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace peria {
+
+// Fixed pool of worker threads for data parallel loops (narrowphase pairs).
+// Every 'parallel_for' splits range into chunks dealt round robin to per thread queues.
+// Thread takes chunks from front of its own queue and, once empty, steals from back
+// of other queues, so uneven chunks (pairs with many pieces) still balance out.
+// Calling thread works too, so pool with 0 workers runs everything inline.
+// Nothing is allocated per call once queues have grown to the largest chunk count.
+class Job_System {
+public:
+    // hardware threads minus the calling one
+    [[nodiscard]]
+    static std::size_t default_worker_count();
+
+    explicit Job_System(std::size_t worker_count = default_worker_count());
+    ~Job_System();
+
+    // workers + calling thread
+    [[nodiscard]]
+    std::size_t thread_count() const
+    { return _queues.size(); }
+
+    // Calls f(begin, end, thread_index) for chunks of [0, count), blocks until all are done.
+    // thread_index is in [0, thread_count()), 0 is calling thread. Use it to pick per thread
+    // output buffers, f must not write shared state. Call from one thread only.
+    template <typename F>
+    void parallel_for(std::size_t count, std::size_t chunk_size, F&& f)
+    {
+        run([](void* context, std::size_t begin, std::size_t end, std::size_t thread_index) {
+                (*static_cast<std::remove_reference_t<F>*>(context))(begin, end, thread_index);
+            }, &f, count, chunk_size);
+    }
+
+private:
+    using Task = void(*)(void* context, std::size_t begin, std::size_t end, std::size_t thread_index);
+
+    struct Range {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    // owner pops from head, thieves pop from back
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::vector<Range> ranges;
+        std::size_t head{};
+    };
+
+    void run(Task task, void* context, std::size_t count, std::size_t chunk_size);
+    void worker_loop(std::size_t thread_index);
+
+    // runs one chunk from own queue or stolen one, false if all queues are empty
+    bool execute_one(std::size_t thread_index);
+
+private:
+    std::vector<std::unique_ptr<Queue>> _queues; // [0] belongs to calling thread
+    std::vector<std::thread> _workers;
+
+    Task _task{};
+    void* _context{};
+    std::atomic<std::size_t> _pending{}; // chunks not finished yet
+
+    std::mutex _wake_mutex;
+    std::condition_variable _wake;
+    uint64_t _generation{}; // bumped for every parallel_for, wakes workers
+    bool _stop{};
+
+public:
+    // workers keep pointer to this
+    Job_System(const Job_System&) = delete;
+    Job_System& operator=(const Job_System&) = delete;
+    Job_System(Job_System&&) = delete;
+    Job_System& operator=(Job_System&&) = delete;
+};
+
+}
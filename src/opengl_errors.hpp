@@ -27,7 +27,8 @@ void log_error(const char* expr, const char* file, int line, const char* msg="")
         expr; \
         PERIA_ASSERT_GL(!gl_check_errors(), #expr, __FILE__, __LINE__)
 #else
-    #define PERIA_ASSERT(expr, msg) expr
+    // expr is still evaluated, some callers rely on its side effects
+    #define PERIA_ASSERT(expr, msg) static_cast<void>(expr)
     #define PERIA_ASSERT_GL(expr, expr_str, file, line)
     #define GL_CALL(expr) expr;
 #endif
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <random>
 
 namespace peria {
+    // random_device only seeds generator, reading it for every number is slow
     inline std::random_device rd = std::random_device();
     inline std::mt19937 generator(rd());
 
@@ -11,7 +13,7 @@ namespace peria {
     int get_int(int l, int r)
     {
         std::uniform_int_distribution<> dist(l, r);
-        return dist(rd);
+        return dist(generator);
     }
 
     [[nodiscard]]
@@ -19,6 +21,15 @@ namespace peria {
     float get_float(float l, float r)
     {
         std::uniform_real_distribution<float> dist(l, r);
-        return dist(rd);
+        return dist(generator);
+    }
+
+    // id of game entity, unique for whole run (never reused, unlike vector indices)
+    [[nodiscard]]
+    inline
+    uint32_t new_entity_id()
+    {
+        static uint32_t next_id{};
+        return next_id++;
     }
 }
@@ -1,9 +1,482 @@
 #include "physics.hpp"
 
 #include <glm/vec2.hpp>
+#include <cmath>
+#include <set>
+
+#include "vertex_batch.hpp"
 
 namespace peria {
 
+bool is_convex(Polygon_View points)
+{
+    PERIA_ASSERT(points.size() >= 3, "Polygon must have at least 3 points");
+    if (points.size() < 3) return false;
+
+    auto p1 = points[1] - points[0];
+    auto p2 = points[2] - points[1];
+    auto direction = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
+
+    for (std::size_t i{}; i<points.size(); ++i) {
+        auto j = (i+1)%points.size();
+        auto k = (i+2)%points.size();
+
+        p1 = points[j]-points[i];
+        p2 = points[k]-points[j];
+        auto d = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
+
+        // direction changed ==> convex
+        if (d != direction) {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+// Ear clipping, cuts ears off points and passes each of them to emit as triangle.
+// Stops when no ear is left or only triangle remains, returns number of remaining points,
+// which are first in points and form convex polygon.
+template <typename Emit>
+std::size_t cut_ears(std::span<glm::vec2> points, Emit&& emit)
+{
+    auto N = points.size();
+    for (std::size_t c{}; c<N && N>3;) {
+        auto p1 = points[1] - points[0];
+        auto p2 = points[2] - points[1];
+        auto direction = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
+        auto cut_ear = false;
+
+        for (std::size_t i{}; i<N && N>3; ++i) {
+            auto j = (i+1)%N;
+            auto k = (i+2)%N;
+
+            p1 = points[j]-points[i];
+            p2 = points[k]-points[j];
+            auto d = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
+            if (d != direction) {
+                emit(points[(i-1)%N], points[i], points[j]);
+                for (std::size_t ii=i; ii<N; ++ii) {
+                    points[ii] = points[(ii+1)%N];
+                }
+                --N;
+                cut_ear = true;
+                break;
+            }
+        }
+        if (!cut_ear) break;
+    }
+    return N;
+}
+
+}
+
+std::vector<Polygon> triangulate(Polygon_View view, bool full_triangulation)
+{
+    auto N = view.size();
+    std::vector<glm::vec2> points(view.begin(), view.end()); // make a copy
+    if (N == 3) return {Polygon{std::move(points)}};
+
+    std::vector<Polygon> res; res.reserve(N-2);
+    N = cut_ears(points, [&res](glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+        res.emplace_back(std::vector{a, b, c});
+    });
+
+    // if cannot cut more 'ears' do triangulation with triangle fan
+    if (full_triangulation) { 
+        for (std::size_t i=1; i<N-1; ++i) {
+            res.emplace_back(std::vector{points[0], points[i], points[i+1]});
+        }
+    }
+    else { // will separate ears until remaining part is convex
+        // at this point first N 'points' contain only remaining vertices
+        // that form convex polygon
+        points.resize(N);
+        res.emplace_back(std::move(points));
+    }
+
+    return res;
+}
+
+void triangulate(Polygon_View view, std::pmr::vector<Triangle>& out)
+{
+    std::pmr::vector<glm::vec2> points(view.begin(), view.end(), out.get_allocator());
+    out.reserve(out.size() + view.size()-2);
+    const auto N = cut_ears(points, [&out](glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+        out.push_back({a, b, c});
+    });
+    for (std::size_t i=1; i<N-1; ++i) {
+        out.push_back({points[0], points[i], points[i+1]});
+    }
+}
+
+std::vector<Polygon> Polygon::triangulate(bool full_triangulation) const
+{ return peria::triangulate(_points, full_triangulation); }
+
+namespace {
+
+[[nodiscard]]
+float cross(glm::vec2 a, glm::vec2 b)
+{ return a.x*b.y - a.y*b.x; }
+
+// sweep goes from top to bottom, points with same y are ordered left to right
+[[nodiscard]]
+bool above(glm::vec2 a, glm::vec2 b)
+{ return a.y > b.y || (a.y == b.y && a.x < b.x); }
+
+using Diagonal = std::pair<uint32_t, uint32_t>;
+
+// Polygon vertices connected by polygon edges and diagonals, stored as half edges.
+// Half edges leaving a vertex are linked in counter clockwise order, so faces can be walked
+// and diagonals removed without searching. Polygon must be counter clockwise.
+class Polygon_Graph {
+public:
+    Polygon_Graph(std::span<const glm::vec2> points, std::span<const Diagonal> diagonals)
+        :_points{points}
+    {
+        const auto n = static_cast<uint32_t>(points.size());
+        _edges.reserve(2*(n + diagonals.size()));
+        for (uint32_t i{}; i<n; ++i) add_pair(i, (i+1)%n, false);
+        for (const auto& [a, b]:diagonals) add_pair(a, b, true);
+
+        // sort half edges around every vertex by angle from polygon edge leaving it,
+        // interior wedge is [next vertex, previous vertex]
+        std::vector<std::vector<uint32_t>> around(n);
+        for (uint32_t e{}; e<_edges.size(); ++e) around[_edges[e].from].push_back(e);
+        for (uint32_t v{}; v<n; ++v) {
+            const auto ref = _points[(v+1)%n] - _points[v];
+            auto angle = [&](uint32_t e) {
+                const auto d = _points[_edges[e].to] - _points[v];
+                const auto a = std::atan2(cross(ref, d), glm::dot(ref, d));
+                return a < 0.0f ? a + 6.2831853f : a;
+            };
+            auto& list = around[v];
+            std::sort(list.begin(), list.end(), [&](uint32_t a, uint32_t b) { return angle(a) < angle(b); });
+            for (std::size_t i{}; i<list.size(); ++i) {
+                _edges[list[i]].ccw = list[(i+1)%list.size()];
+                _edges[list[(i+1)%list.size()]].cw = list[i];
+            }
+        }
+    }
+
+    // counter clockwise faces as vertex indices
+    [[nodiscard]]
+    std::vector<std::vector<uint32_t>> faces() const
+    {
+        std::vector<std::vector<uint32_t>> res;
+        std::vector<bool> visited(_edges.size());
+        for (uint32_t start{}; start<_edges.size(); ++start) {
+            if (visited[start] || !_edges[start].alive || _edges[start].outside) continue;
+
+            auto& face = res.emplace_back();
+            auto e = start;
+            do {
+                visited[e] = true;
+                face.push_back(_edges[e].from);
+                // next edge of face leaves 'to' right before way back, going clockwise
+                e = _edges[_edges[e].twin].cw;
+            } while (e != start);
+        }
+        return res;
+    }
+
+    // Hertel-Mehlhorn step, diagonal can go if wedges left at both its ends stay convex
+    void remove_inessential_diagonals()
+    {
+        for (uint32_t e{}; e<_edges.size(); ++e) {
+            if (!_edges[e].diagonal || !_edges[e].alive || e > _edges[e].twin) continue;
+            if (convex_without(e) && convex_without(_edges[e].twin)) {
+                unlink(e);
+                unlink(_edges[e].twin);
+            }
+        }
+    }
+
+private:
+    struct Half_Edge {
+        uint32_t from;
+        uint32_t to;
+        uint32_t twin;
+        uint32_t ccw{}; // next half edge around 'from'
+        uint32_t cw{};
+        bool diagonal;
+        bool outside; // reversed polygon edge, borders outside of polygon
+        bool alive{true};
+    };
+
+    void add_pair(uint32_t a, uint32_t b, bool diagonal)
+    {
+        const auto e = static_cast<uint32_t>(_edges.size());
+        _edges.push_back({a, b, e+1, 0, 0, diagonal, false});
+        _edges.push_back({b, a, e, 0, 0, diagonal, !diagonal});
+    }
+
+    [[nodiscard]]
+    bool convex_without(uint32_t e) const
+    {
+        const auto& edge = _edges[e];
+        const auto origin = _points[edge.from];
+        return cross(_points[_edges[edge.cw].to] - origin, _points[_edges[edge.ccw].to] - origin) > 0.0f;
+    }
+
+    void unlink(uint32_t e)
+    {
+        auto& edge = _edges[e];
+        _edges[edge.cw].ccw = edge.ccw;
+        _edges[edge.ccw].cw = edge.cw;
+        edge.alive = false;
+    }
+
+private:
+    std::span<const glm::vec2> _points;
+    std::vector<Half_Edge> _edges;
+};
+
+// Diagonals splitting counter clockwise polygon into y-monotone pieces (sweep line, de Berg et al.).
+// Status holds edges with polygon interior on their right, ordered by x at sweep position,
+// each with helper vertex which split and merge vertices are connected to.
+[[nodiscard]]
+std::vector<Diagonal> monotone_diagonals(std::span<const glm::vec2> points)
+{
+    enum class Vertex_Kind { START, SPLIT, END, MERGE, REGULAR };
+
+    const auto n = static_cast<uint32_t>(points.size());
+    auto prev = [&](uint32_t i) { return (i+n-1)%n; };
+    auto next = [&](uint32_t i) { return (i+1)%n; };
+
+    std::vector<Vertex_Kind> kinds(n);
+    for (uint32_t i{}; i<n; ++i) {
+        const auto p = points[prev(i)];
+        const auto v = points[i];
+        const auto nx = points[next(i)];
+        const auto convex = cross(v - p, nx - v) > 0.0f;
+        if (above(v, p) && above(v, nx))      kinds[i] = convex ? Vertex_Kind::START : Vertex_Kind::SPLIT;
+        else if (above(p, v) && above(nx, v)) kinds[i] = convex ? Vertex_Kind::END : Vertex_Kind::MERGE;
+        else                                  kinds[i] = Vertex_Kind::REGULAR;
+    }
+
+    std::vector<uint32_t> order(n);
+    for (uint32_t i{}; i<n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return above(points[a], points[b]); });
+
+    // edge i goes from vertex i to i+1
+    glm::vec2 sweep{};
+    auto x_at = [&](uint32_t e) {
+        const auto a = points[e];
+        const auto b = points[next(e)];
+        // horizontal edge is treated as slightly tilted, sweep point is on it
+        if (a.y == b.y) return std::clamp(sweep.x, std::min(a.x, b.x), std::max(a.x, b.x));
+        return a.x + (sweep.y - a.y) / (b.y - a.y) * (b.x - a.x);
+    };
+
+    struct Sweep_X {
+        float x;
+    };
+    struct Edge_Order {
+        using is_transparent = void;
+        const decltype(x_at)* x_of;
+        bool operator()(uint32_t a, uint32_t b) const { return (*x_of)(a) < (*x_of)(b); }
+        bool operator()(uint32_t a, Sweep_X b) const { return (*x_of)(a) < b.x; }
+        bool operator()(Sweep_X a, uint32_t b) const { return a.x < (*x_of)(b); }
+    };
+    using Status = std::set<uint32_t, Edge_Order>;
+    Status status{Edge_Order{&x_at}};
+    std::vector<Status::iterator> in_status(n, status.end());
+    std::vector<uint32_t> helper(n);
+    std::vector<Diagonal> res;
+
+    auto insert = [&](uint32_t e, uint32_t v) {
+        in_status[e] = status.insert(e).first;
+        helper[e] = v;
+    };
+    auto erase = [&](uint32_t e) {
+        status.erase(in_status[e]);
+        in_status[e] = status.end();
+    };
+    auto connect_merge_helper = [&](uint32_t e, uint32_t v) {
+        if (kinds[helper[e]] == Vertex_Kind::MERGE) res.emplace_back(v, helper[e]);
+    };
+    // edge with interior on its right that is directly left of sweep point
+    auto left_edge = [&]() {
+        auto it = status.lower_bound(Sweep_X{sweep.x});
+        PERIA_ASSERT(it != status.begin(), "convex_decompose: polygon is not simple");
+        return *--it;
+    };
+
+    for (const auto v:order) {
+        sweep = points[v];
+        switch (kinds[v]) {
+            case Vertex_Kind::START:
+                insert(v, v);
+                break;
+            case Vertex_Kind::END:
+                connect_merge_helper(prev(v), v);
+                erase(prev(v));
+                break;
+            case Vertex_Kind::SPLIT: {
+                const auto e = left_edge();
+                res.emplace_back(v, helper[e]);
+                helper[e] = v;
+                insert(v, v);
+                break;
+            }
+            case Vertex_Kind::MERGE: {
+                connect_merge_helper(prev(v), v);
+                erase(prev(v));
+                const auto e = left_edge();
+                connect_merge_helper(e, v);
+                helper[e] = v;
+                break;
+            }
+            case Vertex_Kind::REGULAR:
+                if (above(points[prev(v)], points[v])) { // interior lies right of v
+                    connect_merge_helper(prev(v), v);
+                    erase(prev(v));
+                    insert(v, v);
+                }
+                else {
+                    const auto e = left_edge();
+                    connect_merge_helper(e, v);
+                    helper[e] = v;
+                }
+                break;
+        }
+    }
+    return res;
+}
+
+// Appends diagonals triangulating y-monotone counter clockwise face in linear time
+// (after sort), vertices of face are indices into points.
+void triangulate_monotone(std::span<const glm::vec2> points, const std::vector<uint32_t>& face, std::vector<Diagonal>& out)
+{
+    const auto k = face.size();
+    if (k <= 3) return;
+
+    // position of vertex in face, chains split at top and bottom vertex
+    std::vector<uint32_t> order(k);
+    for (uint32_t i{}; i<k; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return above(points[face[a]], points[face[b]]); });
+
+    // walking counter clockwise from top goes down left chain
+    std::vector<bool> left(k);
+    for (auto i=order.front(); i!=order.back(); i=(i+1)%k) left[i] = true;
+
+    auto adjacent = [&](uint32_t a, uint32_t b) { return (a+1)%k == b || (b+1)%k == a; };
+    auto add = [&](uint32_t a, uint32_t b) {
+        if (!adjacent(a, b)) out.emplace_back(face[a], face[b]);
+    };
+    // diagonal from u to s doesn't leave polygon around 'last' which is between them on chain
+    auto inside = [&](uint32_t u, uint32_t last, uint32_t s) {
+        const auto c = cross(points[face[s]] - points[face[u]], points[face[last]] - points[face[u]]);
+        return left[u] ? c > 0.0f : c < 0.0f;
+    };
+
+    std::vector<uint32_t> stack{order[0], order[1]};
+    for (std::size_t j=2; j<k-1; ++j) {
+        const auto u = order[j];
+        if (left[u] != left[stack.back()]) {
+            while (stack.size() > 1) {
+                add(u, stack.back());
+                stack.pop_back();
+            }
+            stack.clear();
+            stack.push_back(order[j-1]);
+            stack.push_back(u);
+        }
+        else {
+            auto last = stack.back();
+            stack.pop_back();
+            while (!stack.empty() && inside(u, last, stack.back())) {
+                last = stack.back();
+                add(u, last);
+                stack.pop_back();
+            }
+            stack.push_back(last);
+            stack.push_back(u);
+        }
+    }
+
+    // bottom vertex sees everything left on stack
+    for (std::size_t i=1; i+1<stack.size(); ++i) add(order.back(), stack[i]);
+}
+
+}
+
+std::vector<Polygon> convex_decompose(Polygon_View view)
+{
+    const auto n = view.size();
+    PERIA_ASSERT(n >= 3, "Polygon must have at least 3 points");
+    if (is_convex(view)) return {Polygon{std::vector(view.begin(), view.end())}};
+
+    // work on counter clockwise copy
+    float area{};
+    for (std::size_t i{}; i<n; ++i) area += cross(view[i], view[(i+1)%n]);
+    const auto clockwise = area < 0.0f;
+    std::vector<glm::vec2> points(view.begin(), view.end());
+    if (clockwise) std::reverse(points.begin(), points.end());
+
+    auto diagonals = monotone_diagonals(points);
+    for (const auto& face:Polygon_Graph{points, diagonals}.faces()) {
+        triangulate_monotone(points, face, diagonals);
+    }
+
+    Polygon_Graph graph{points, diagonals};
+    graph.remove_inessential_diagonals();
+
+    std::vector<Polygon> res;
+    for (const auto& face:graph.faces()) {
+        std::vector<glm::vec2> piece;
+        piece.reserve(face.size());
+        for (const auto v:face) piece.push_back(points[v]);
+        if (clockwise) std::reverse(piece.begin(), piece.end());
+        res.emplace_back(std::move(piece));
+    }
+    return res;
+}
+
+std::vector<Polygon> Polygon::convex_decompose() const
+{ return peria::convex_decompose(_points); }
+
+std::vector<glm::vec2> unique_axes(Polygon_View points)
+{
+    std::vector<glm::vec2> axes;
+    for (std::size_t i{}; i<points.size(); ++i) {
+        auto edge = points[(i+1)%points.size()] - points[i];
+        auto axis = glm::normalize(glm::vec2{-edge.y, edge.x});
+
+        // axis and its opposite give same projections, keep one
+        if (axis.x < 0.0f || (axis.x == 0.0f && axis.y < 0.0f)) axis = -axis;
+
+        const auto parallel = std::any_of(axes.begin(), axes.end(), [&](glm::vec2 a) {
+            return std::abs(a.x*axis.y - a.y*axis.x) < 1e-5f;
+        });
+        if (!parallel) axes.push_back(axis);
+    }
+    return axes;
+}
+
+Convex_Model make_convex_model(Polygon_View model)
+{
+    Convex_Model res;
+    res.pieces = convex_decompose(model);
+
+    // pieces reuse outline vertices, so they can be gathered from outline moved to world space
+    for (const auto& piece:res.pieces) {
+        auto& indices = res.indices.emplace_back();
+        for (const auto& p:piece.points()) {
+            const auto it = std::find(model.begin(), model.end(), p);
+            PERIA_ASSERT(it != model.end(), "convex piece vertex is not on model outline");
+            indices.push_back(static_cast<uint32_t>(it - model.begin()));
+        }
+    }
+
+    for (const auto& piece:res.pieces) {
+        res.axes.push_back(unique_axes(piece));
+    }
+    return res;
+}
+
 bool aabb(const AABB_Collider &a, const AABB_Collider &b)
 {
     const auto& ax = a.pos.x;
@@ -21,6 +494,41 @@ bool aabb(const AABB_Collider &a, const AABB_Collider &b)
     return overlap_x && overlap_y;
 }
 
+AABB_Collider aabb_of(Polygon_View points)
+{
+    auto mn = glm::vec2{std::numeric_limits<float>::max()};
+    auto mx = glm::vec2{std::numeric_limits<float>::lowest()};
+    for (const auto& p:points) {
+        mn = glm::min(mn, p);
+        mx = glm::max(mx, p);
+    }
+    return {{mn.x, mx.y}, mx-mn};
+}
+
+AABB_Collider aabb_of(std::span<const Small_Polygon> pieces)
+{
+    auto mn = glm::vec2{std::numeric_limits<float>::max()};
+    auto mx = glm::vec2{std::numeric_limits<float>::lowest()};
+    for (const auto& piece:pieces) {
+        for (const auto& p:piece.points()) {
+            mn = glm::min(mn, p);
+            mx = glm::max(mx, p);
+        }
+    }
+    return {{mn.x, mx.y}, mx-mn};
+}
+
+Bounds swept_square_bounds(glm::vec2 from, glm::vec2 to, float half_side)
+{
+    const auto mn = glm::min(from, to) - half_side;
+    const auto mx = glm::max(from, to) + half_side;
+    return {
+        (from+to)*0.5f,
+        half_side*std::sqrt(2.0f) + glm::length(to-from)*0.5f,
+        {{mn.x, mx.y}, mx-mn}
+    };
+}
+
 bool circle_circle(glm::vec2 a, float a_radius, glm::vec2 b, float b_radius)
 {
     auto x = a.x-b.x;
@@ -110,10 +618,10 @@ bool sat(const std::vector<glm::vec2>& a, const std::vector<glm::vec2>& b)
 // Caller must triangulate or modify polygons before calling 'sat()'.
 // Rotation of edge vector is in anti-clockwise direction.
 // Algorithm Does not consider collision resolution
-bool sat(const Polygon& poly1, const Polygon& poly2)
+bool sat(Polygon_View a, Polygon_View b)
 {
     // helper lambda to find interval extrema after projection
-    auto min_max_after_projection = [](const std::vector<glm::vec2>& points,
+    auto min_max_after_projection = [](Polygon_View points,
                                        glm::vec2 axis) -> std::pair<float, float> {
         auto mn = std::numeric_limits<float>::max();
         auto mx = std::numeric_limits<float>::lowest();
@@ -127,9 +635,6 @@ bool sat(const Polygon& poly1, const Polygon& poly2)
         return {mn, mx};
     };
 
-    const auto& a = poly1.points();
-    const auto& b = poly2.points();
-
     // test axis of polygon a
     for (std::size_t i{}; i<a.size(); ++i) {
         auto p1 = a[i];
@@ -168,17 +673,61 @@ bool sat(const Polygon& poly1, const Polygon& poly2)
     return true;
 }
 
-bool concave_sat(const Polygon& a, const Polygon& b)
+namespace {
+
+std::pair<float, float> project(Polygon_View points, glm::vec2 axis)
 {
-    std::vector<Polygon> as {a};
-    if (!a.is_convex()) {
-        as = a.triangulate(false);
+    auto mn = std::numeric_limits<float>::max();
+    auto mx = std::numeric_limits<float>::lowest();
+    for (const auto& p:points) {
+        auto projected = glm::dot(axis, p);
+        mn = std::min(mn, projected);
+        mx = std::max(mx, projected);
     }
-    std::vector<Polygon> bs {b};
-    if (!b.is_convex()) {
-        bs = b.triangulate(false);
+    return {mn, mx};
+}
+
+// calls f with every separating axis of polygon until f returns false.
+// precomputed axes are used when given, otherwise edge normals are built from points.
+template <typename F>
+bool for_each_axis(Polygon_View points, Axes_View axes, F&& f)
+{
+    if (!axes.empty()) {
+        for (const auto& axis:axes) {
+            if (!f(axis)) return false;
+        }
+        return true;
     }
 
+    for (std::size_t i{}; i<points.size(); ++i) {
+        auto edge = points[(i+1)%points.size()] - points[i];
+        if (!f(glm::vec2{-edge.y, edge.x})) return false;
+    }
+    return true;
+}
+
+}
+
+bool sat(Polygon_View a, Axes_View a_axes, Polygon_View b, Axes_View b_axes)
+{
+    auto overlap = [&](glm::vec2 axis) {
+        auto [min_a, max_a] = project(a, axis);
+        auto [min_b, max_b] = project(b, axis);
+        return !((max_a < min_b) || (max_b < min_a));
+    };
+    return for_each_axis(a, a_axes, overlap) && for_each_axis(b, b_axes, overlap);
+}
+
+bool concave_sat(Polygon_View a, Polygon_View b)
+{
+    const auto a_convex = is_convex(a);
+    const auto b_convex = is_convex(b);
+    if (a_convex && b_convex) return sat(a, b);
+
+    // slow path, only for polygons without cached pieces
+    auto as = a_convex ? std::vector{Polygon{std::vector(a.begin(), a.end())}} : triangulate(a, false);
+    auto bs = b_convex ? std::vector{Polygon{std::vector(b.begin(), b.end())}} : triangulate(b, false);
+
     for (const auto& part_a:as) {
         for (const auto& part_b:bs) {
             if (sat(part_a, part_b)) 
@@ -189,6 +738,258 @@ bool concave_sat(const Polygon& a, const Polygon& b)
     return false;
 }
 
+bool concave_sat(std::span<const Small_Polygon> a_pieces, std::span<const Small_Polygon> b_pieces)
+{
+    for (const auto& part_a:a_pieces) {
+        for (const auto& part_b:b_pieces) {
+            if (sat(part_a, part_a.axes(), part_b, part_b.axes())) 
+                return true;
+        }
+    }
+    return false;
+}
+
+bool concave_sat(Polygon_View convex, Axes_View convex_axes, std::span<const Small_Polygon> pieces)
+{
+    for (const auto& part:pieces) {
+        if (sat(convex, convex_axes, part, part.axes())) 
+            return true;
+    }
+    return false;
+}
+
+std::optional<float> sweep_sat(Polygon_View moving, Axes_View moving_axes, glm::vec2 displacement,
+                               Polygon_View target, Axes_View target_axes)
+{
+    // interval of time in which projections overlap on every axis tested so far
+    float t_first = 0.0f;
+    float t_last = 1.0f;
+
+    // narrows [t_first, t_last] by overlap interval on given axis.
+    // returns false if they are separated on this axis during whole displacement
+    auto sweep_axis = [&](glm::vec2 axis) -> bool {
+        auto [min_a, max_a] = project(moving, axis);
+        auto [min_b, max_b] = project(target, axis);
+        auto v = glm::dot(axis, displacement);
+
+        if (v == 0.0f) { // not moving along this axis, plain SAT test
+            return !((max_a < min_b) || (max_b < min_a));
+        }
+
+        auto t_enter = (v > 0.0f ? min_b - max_a : max_b - min_a) / v;
+        auto t_exit  = (v > 0.0f ? max_b - min_a : min_b - max_a) / v;
+        t_first = std::max(t_first, t_enter);
+        t_last = std::min(t_last, t_exit);
+        return t_first <= t_last;
+    };
+
+    if (!for_each_axis(moving, moving_axes, sweep_axis) ||
+        !for_each_axis(target, target_axes, sweep_axis)) return std::nullopt;
+
+    return t_first;
+}
+
+std::optional<float> sweep_concave_sat(Polygon_View moving, Axes_View moving_axes, glm::vec2 displacement,
+                                       std::span<const Small_Polygon> pieces, glm::vec2* separating_axis)
+{
+    std::optional<float> earliest;
+    for (const auto& part:pieces) {
+        auto toi = sweep_sat(moving, moving_axes, displacement, part, part.axes());
+        if (toi && (!earliest || *toi < *earliest)) earliest = toi;
+    }
+
+    if (separating_axis && !earliest) {
+        // Axis separating moving polygon from all pieces at once. Edge normals of single pieces
+        // rarely separate whole concave polygon, axis between centers and axis perpendicular
+        // to motion usually do and are cheap to try.
+        auto center = [](Polygon_View points) {
+            glm::vec2 sum{};
+            for (const auto& p:points) sum += p;
+            return sum / static_cast<float>(points.size());
+        };
+        glm::vec2 pieces_center{};
+        for (const auto& part:pieces) pieces_center += center(part);
+        pieces_center /= static_cast<float>(pieces.size());
+
+        *separating_axis = {};
+        for (const auto axis:{center(moving) - pieces_center, glm::vec2{-displacement.y, displacement.x}}) {
+            if (axis != glm::vec2{0.0f} && sweep_separates(axis, moving, displacement, pieces)) {
+                *separating_axis = axis;
+                break;
+            }
+        }
+    }
+    return earliest;
+}
+
+bool sweep_separates(glm::vec2 axis, Polygon_View moving, glm::vec2 displacement, std::span<const Small_Polygon> pieces)
+{
+    auto [min_a, max_a] = project(moving, axis);
+    // moving polygon covers both start and end interval during sweep
+    const auto v = glm::dot(axis, displacement);
+    min_a += std::min(v, 0.0f);
+    max_a += std::max(v, 0.0f);
+
+    for (const auto& part:pieces) {
+        auto [min_b, max_b] = project(part, axis);
+        if (!((max_a < min_b) || (max_b < min_a))) return false;
+    }
+    return true;
+}
+
+std::optional<Segment_Hit> segment_cast(Polygon_View convex, glm::vec2 from, glm::vec2 to)
+{
+    const auto d = to - from;
+    // turn of first corner gives winding of whole convex polygon, edge normal is flipped to point outward
+    const auto e0 = convex[1] - convex[0];
+    const auto e1 = convex[2] - convex[1];
+    const auto outward = e0.x*e1.y - e0.y*e1.x > 0.0f ? 1.0f : -1.0f;
+
+    // Cyrus-Beck, segment is clipped to inside of each edge line in turn
+    auto t_enter = 0.0f;
+    auto t_exit = 1.0f;
+    glm::vec2 enter_normal{};
+    for (std::size_t i{}; i<convex.size(); ++i) {
+        const auto a = convex[i];
+        const auto edge = convex[(i+1)%convex.size()] - a;
+        const auto n = glm::vec2{edge.y, -edge.x} * outward;
+
+        const auto distance = glm::dot(n, a - from); // negative if from is outside of this edge
+        const auto speed = glm::dot(n, d);
+        if (speed == 0.0f) {
+            if (distance < 0.0f) return std::nullopt; // parallel and outside
+            continue;
+        }
+        const auto t = distance / speed;
+        if (speed < 0.0f) {
+            if (t > t_enter) {
+                t_enter = t;
+                enter_normal = n;
+            }
+        }
+        else {
+            t_exit = std::min(t_exit, t);
+        }
+        if (t_enter > t_exit) return std::nullopt;
+    }
+
+    if (enter_normal == glm::vec2{0.0f}) {
+        // starts inside
+        return Segment_Hit{0.0f, d == glm::vec2{0.0f} ? glm::vec2{0.0f} : -glm::normalize(d)};
+    }
+    return Segment_Hit{t_enter, glm::normalize(enter_normal)};
+}
+
+std::optional<Segment_Hit> segment_cast(std::span<const Small_Polygon> pieces, glm::vec2 from, glm::vec2 to)
+{
+    std::optional<Segment_Hit> earliest;
+    for (const auto& part:pieces) {
+        const auto hit = segment_cast(part, from, to);
+        if (hit && (!earliest || hit->fraction < earliest->fraction)) earliest = hit;
+    }
+    return earliest;
+}
+
+std::optional<Segment_Hit> segment_cast(const Bounds& bounds, std::span<const Small_Polygon> pieces, glm::vec2 from, glm::vec2 to)
+{
+    // closest point of segment to center
+    const auto d = to - from;
+    const auto len2 = glm::dot(d, d);
+    const auto t = len2 > 0.0f ? std::clamp(glm::dot(bounds.center - from, d) / len2, 0.0f, 1.0f) : 0.0f;
+    const auto closest = from + d*t - bounds.center;
+    if (glm::dot(closest, closest) > bounds.radius*bounds.radius) return std::nullopt;
+
+    return segment_cast(pieces, from, to);
+}
+
+void to_world(const std::vector<Polygon>& model_pieces, const Transform& t, std::vector<Small_Polygon>& world_pieces)
+{
+    world_pieces.resize(model_pieces.size());
+    const auto affine = Affine_2d::from(t);
+    for (std::size_t i{}; i<model_pieces.size(); ++i) {
+        const auto& src = model_pieces[i].points();
+        auto& dst = world_pieces[i];
+        dst.resize(src.size());
+        dst.resize_axes(0); // no model space axes, sat builds them from edges
+        transform_points(affine, src, dst.points());
+    }
+}
+
+namespace {
+
+// normals transform with inverse transpose of model matrix, which is rotation times inverse scale.
+// sat doesn't need unit axes, so they are not normalized again
+void axes_to_world(const Convex_Model& model, const Transform& t, std::span<Small_Polygon> world_pieces)
+{
+    const auto angle = glm::radians(t.angle);
+    const auto c = std::cos(angle);
+    const auto s = std::sin(angle);
+    for (std::size_t i{}; i<model.axes.size(); ++i) {
+        const auto& src = model.axes[i];
+        auto& dst = world_pieces[i];
+        dst.resize_axes(src.size());
+        auto dst_axes = dst.axes();
+        for (std::size_t j{}; j<src.size(); ++j) {
+            const auto n = src[j] / t.scale;
+            dst_axes[j] = {c*n.x - s*n.y, s*n.x + c*n.y};
+        }
+    }
+}
+
+}
+
+void to_world(const Convex_Model& model, const Transform& t, std::vector<Small_Polygon>& world_pieces)
+{
+    to_world(model.pieces, t, world_pieces);
+    axes_to_world(model, t, world_pieces);
+}
+
+void to_world(const Convex_Model& model, const Transform& t, Polygon_View world_outline, std::vector<Small_Polygon>& world_pieces)
+{
+    world_pieces.resize(model.indices.size());
+    to_world(model, t, world_outline, std::span{world_pieces});
+}
+
+void to_world(const Convex_Model& model, const Transform& t, Polygon_View world_outline, std::span<Small_Polygon> world_pieces)
+{
+    PERIA_ASSERT(world_pieces.size() == model.indices.size(), "world_pieces must hold one piece per model piece");
+    for (std::size_t i{}; i<model.indices.size(); ++i) {
+        const auto& src = model.indices[i];
+        auto& dst = world_pieces[i];
+        dst.resize(src.size());
+        auto dst_points = dst.points();
+        for (std::size_t j{}; j<src.size(); ++j) {
+            dst_points[j] = world_outline[src[j]];
+        }
+    }
+    axes_to_world(model, t, world_pieces);
+}
+
+void translate(std::span<Small_Polygon> pieces, glm::vec2 offset)
+{
+    for (auto& piece:pieces) {
+        for (auto& p:piece.points()) p += offset;
+    }
+}
+
+glm::vec2 screen_wrap_offset(const AABB_Collider& aabb, glm::vec2 world_size)
+{
+    const auto min_x = aabb.pos.x;
+    const auto max_x = aabb.pos.x+aabb.size.x;
+    const auto min_y = aabb.pos.y-aabb.size.y;
+    const auto max_y = aabb.pos.y;
+    const auto w = world_size.x;
+    const auto h = world_size.y;
+
+    glm::vec2 offset{};
+    if (min_x > w)         offset.x = -(w+max_x-min_x);
+    else if (max_x < 0.0f) offset.x = w+max_x-min_x;
+
+    if (min_y > h)         offset.y = -(h+max_y-min_y);
+    else if (max_y < 0.0f) offset.y = h+max_y-min_y;
+    return offset;
+}
+
 float lerp(float a, float b, float alpha)
 { return (1.0f - alpha)*a + b*alpha; }
 
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <span>
 #include <vector>
 #include <iostream>
+#include <memory_resource>
+#include <optional>
 #include "opengl_errors.hpp"
 #include "peria_logger.hpp"
 #include "transform.hpp"
@@ -13,6 +18,32 @@ struct AABB_Collider {
     glm::vec2 size;
 };
 
+// cheap bounding volumes, cached per entity and updated once per tick.
+// used to reject pairs before any polygon work.
+struct Bounds {
+    glm::vec2 center{};
+    float radius{};
+    AABB_Collider aabb{};
+};
+
+// how many narrowphase calls were rejected at each stage during one tick
+struct Narrowphase_Stats {
+    std::size_t calls{};
+    std::size_t circle_rejected{};
+    std::size_t aabb_rejected{};
+    std::size_t sat_rejected{};
+
+    // sums stats gathered on different threads
+    Narrowphase_Stats& operator+=(const Narrowphase_Stats& o)
+    {
+        calls += o.calls;
+        circle_rejected += o.circle_rejected;
+        aabb_rejected += o.aabb_rejected;
+        sat_rejected += o.sat_rejected;
+        return *this;
+    }
+};
+
 // debug lines for normal vectors
 struct Line {
     glm::vec2 p1;
@@ -39,6 +70,50 @@ struct Line {
 
 };
 
+// non owning view of polygon points, in clockwise order.
+// every polygon type below converts to it, so collision routines don't care about storage.
+using Polygon_View = std::span<const glm::vec2>;
+
+// separating axes of convex polygon (edge normals), see 'unique_axes()'.
+// empty view means axes are not precomputed and are built from polygon edges.
+using Axes_View = std::span<const glm::vec2>;
+
+// separating axes of axis aligned rectangles (bullets)
+inline const std::array<glm::vec2, 2> AXIS_ALIGNED_AXES{{{1.0f, 0.0f}, {0.0f, 1.0f}}};
+
+// unit edge normals of convex polygon with parallel duplicates removed,
+// e.g. rectangle has 4 edges but only 2 axes
+[[nodiscard]]
+std::vector<glm::vec2> unique_axes(Polygon_View points);
+
+// check if polygon is convex
+[[nodiscard]]
+bool is_convex(Polygon_View points);
+
+class Polygon;
+
+// Simple Polygon triangulation using O(n^2) algorithm (Ear clipping).
+// Function Assumes that Polygon does not have holes or is self intersecting or contains 3 collinear points.
+// Pass bool::true to stop triangulating if sub-polygon becomes convex.
+// Returns std::vector of new Polygons which are triangles
+[[nodiscard]]
+std::vector<Polygon> triangulate(Polygon_View points, bool full_triangulation = true);
+
+// points in same order as in polygon
+using Triangle = std::array<glm::vec2, 3>;
+
+// Full triangulation same as above, triangles are appended to out. Scratch copy of points
+// uses allocator of out, so with 'Frame_Arena' nothing touches heap.
+void triangulate(Polygon_View points, std::pmr::vector<Triangle>& out);
+
+// Splits simple polygon into few convex pieces in O(n log n) (Hertel-Mehlhorn).
+// Polygon is split into y-monotone pieces by sweep line, those are triangulated and then
+// every diagonal whose removal keeps both of its ends convex is removed again.
+// Result has at most 4 times the minimal number of pieces, usually close to minimum.
+// Same assumptions as 'triangulate()', pieces keep winding of input polygon.
+[[nodiscard]]
+std::vector<Polygon> convex_decompose(Polygon_View points);
+
 // Simple polygon used for collider
 class Polygon {
 public:
@@ -64,88 +139,15 @@ public:
 
     [[nodiscard]]
     bool is_convex() const
-    {
-        PERIA_ASSERT(_points.size() >= 3, "Polygon must have at least 3 _points");
-        if (_points.size() < 3) return false;
-
-        auto p1 = _points[1] - _points[0];
-        auto p2 = _points[2] - _points[1];
-        auto direction = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
-
-        for (std::size_t i{}; i<_points.size(); ++i) {
-            auto j = (i+1)%_points.size();
-            auto k = (i+2)%_points.size();
-
-            p1 = _points[j]-_points[i];
-            p2 = _points[k]-_points[j];
-            auto d = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
-
-            // direction changed ==> convex
-            if (d != direction) {
-                return false;
-            }
-        }
-        return true;
-    }
+    { return peria::is_convex(_points); }
 
-    // Simple Polygon triangulation using O(n^2) algorithm (Ear clipping).
-    // Function Assumes that Polygon does not have holes or is self intersecting or contains 3 collinear points.
-    // Pass bool::true to stop triangulating if sub-polygon becomes convex.
-    // Returns std::vector of new Polygons which are triangles
+    // see peria::triangulate()
     [[nodiscard]]
-    std::vector<Polygon> triangulate(bool full_triangulation = true) const
-    {
-        auto N = _points.size();
-        if (_points.size() == 3) return {*this};
-
-        auto points = _points; // make a copy
-
-        std::vector<Polygon> res; res.reserve(N-2);
-
-        for (std::size_t c{}; c<N && N>3;) {
-            auto p1 = points[1] - points[0];
-            auto p2 = points[2] - points[1];
-            auto direction = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
-            auto cut_ear = false;
-
-            for (std::size_t i{}; i<N && N>3; ++i) {
-                auto j = (i+1)%N;
-                auto k = (i+2)%N;
-
-                p1 = points[j]-points[i];
-                p2 = points[k]-points[j];
-                auto d = (p1.x*p2.y - p2.x*p1.y) < 0.0f;
-                if (d != direction) {
-                    res.emplace_back(std::vector{points[(i-1)%N], points[i], points[j]});
-                    for (std::size_t ii=i; ii<N; ++ii) {
-                        points[ii] = std::move(points[(ii+1)%N]);
-                    }
-                    --N;
-                    cut_ear = true;
-                    break;
-                }
-            }
-            if (!cut_ear) break;
-        }
-
-        // if cannot cut more 'ears' do triangulation with triangle fan
-        if (full_triangulation) { 
-            for (std::size_t i=1; i<N-1; ++i) {
-                res.emplace_back(std::vector{points[0], points[i], points[i+1]});
-            }
-        }
-        else { // will separate ears until remaining part is convex
-            std::vector<glm::vec2> ps; ps.reserve(N); // temp
-            // at this point 'points' contains only remaining vertices
-            // that form convex polygon
-            for (std::size_t i=0; i<N; ++i) {
-                ps.emplace_back(std::move(points[i]));
-            }
-            res.emplace_back(std::move(ps));
-        }
-
-        return res;
-    }
+    std::vector<Polygon> triangulate(bool full_triangulation = true) const;
+
+    // see peria::convex_decompose()
+    [[nodiscard]]
+    std::vector<Polygon> convex_decompose() const;
 
     [[nodiscard]]
     const auto& points() const
@@ -155,10 +157,98 @@ public:
     auto& points()
     { return _points; }
 
+    operator Polygon_View() const
+    { return _points; }
+
 private:
     std::vector<glm::vec2> _points;
 };
 
+// Polygon with fixed capacity and inline storage.
+// Used on collision hot path, so building or copying one never touches heap.
+template <std::size_t N>
+class Static_Polygon {
+public:
+    static constexpr std::size_t CAPACITY = N;
+
+    Static_Polygon() = default;
+
+    // polygon points are ordered in clockwise direction.
+    explicit Static_Polygon(Polygon_View ps)
+    { assign(ps); }
+
+    void assign(Polygon_View ps)
+    {
+        PERIA_ASSERT(ps.size() <= N, "Static_Polygon capacity exceeded");
+        resize(ps.size());
+        std::copy(ps.begin(), ps.end(), _points.begin());
+        _axis_count = 0;
+    }
+
+    void resize(std::size_t size)
+    {
+        PERIA_ASSERT(size <= N, "Static_Polygon capacity exceeded");
+        _size = size;
+    }
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _size; }
+
+    [[nodiscard]]
+    bool is_convex() const
+    { return peria::is_convex(points()); }
+
+    [[nodiscard]]
+    std::span<const glm::vec2> points() const
+    { return {_points.data(), _size}; }
+
+    [[nodiscard]]
+    std::span<glm::vec2> points()
+    { return {_points.data(), _size}; }
+
+    operator Polygon_View() const
+    { return points(); }
+
+    // precomputed separating axes, filled by 'to_world()' from model space axes.
+    // empty if not precomputed, sat then builds normals from edges.
+    [[nodiscard]]
+    Axes_View axes() const
+    { return {_axes.data(), _axis_count}; }
+
+    [[nodiscard]]
+    std::span<glm::vec2> axes()
+    { return {_axes.data(), _axis_count}; }
+
+    void resize_axes(std::size_t count)
+    {
+        PERIA_ASSERT(count <= N, "Static_Polygon capacity exceeded");
+        _axis_count = count;
+    }
+
+private:
+    std::array<glm::vec2, N> _points{};
+    std::size_t _size{};
+
+    std::array<glm::vec2, N> _axes{};
+    std::size_t _axis_count{};
+};
+
+// largest model has 16 vertices, so any convex piece fits
+using Small_Polygon = Static_Polygon<16>;
+
+// convex pieces of rigid model (asteroid, ship) with their separating axes, in model space.
+// built once per model, per tick only moved to world space with 'to_world()'.
+struct Convex_Model {
+    std::vector<Polygon> pieces;
+    std::vector<std::vector<glm::vec2>> axes; // unique_axes() of each piece
+    std::vector<std::vector<uint32_t>> indices; // vertices of each piece as indices into model outline
+};
+
+// splits model into convex pieces (see convex_decompose()) and precomputes their axes
+[[nodiscard]]
+Convex_Model make_convex_model(Polygon_View model);
+
 // for debug
 inline
 std::vector<Line> normal_lines_a;
@@ -169,6 +259,20 @@ std::vector<Line> normal_lines_b;
 [[nodiscard]]
 bool aabb(const AABB_Collider& a, const AABB_Collider& b);
 
+// smallest axis aligned rectangle containing all points.
+// pos is top left corner, same as for other AABB_Collider users.
+[[nodiscard]]
+AABB_Collider aabb_of(Polygon_View points);
+
+// same as above for all vertices of convex pieces
+[[nodiscard]]
+AABB_Collider aabb_of(std::span<const Small_Polygon> pieces);
+
+// bounds of axis aligned square with given half side, swept from 'from' to 'to'.
+// used by bullets, so broadphase and early outs see whole path travelled during tick
+[[nodiscard]]
+Bounds swept_square_bounds(glm::vec2 from, glm::vec2 to, float half_side);
+
 // check if two circles collide
 [[nodiscard]]
 bool circle_circle(glm::vec2 a, float a_radius, glm::vec2 b, float b_radius);
@@ -184,12 +288,133 @@ bool sat(const std::vector<glm::vec2>& a, const std::vector<glm::vec2>& b);
 // Rotation of edge vector is in anti-clockwise direction.
 // Algorithm Does not consider collision resolution
 [[nodiscard]]
-bool sat(const Polygon& a, const Polygon& b);
+bool sat(Polygon_View a, Polygon_View b);
+
+[[nodiscard]]
+inline
+bool sat(const Polygon& a, const Polygon& b)
+{ return sat(Polygon_View{a}, Polygon_View{b}); }
+
+// same as above, but tests only given axes of each polygon.
+// empty axes are built from edges of that polygon.
+[[nodiscard]]
+bool sat(Polygon_View a, Axes_View a_axes, Polygon_View b, Axes_View b_axes);
 
 // check if any two simple polygons intersect.
 // will triangulate polygons if concave and check sat on triangles.
+// does not allocate when both polygons are convex.
+[[nodiscard]]
+bool concave_sat(Polygon_View a, Polygon_View b);
+
+// check if two polygons intersect, given their convex pieces.
+// pieces are usually cached once per model (see 'make_convex_model()')
+// and moved to world space with 'to_world()', so nothing is allocated or triangulated here.
+// precomputed axes of pieces are used when present.
+[[nodiscard]]
+bool concave_sat(std::span<const Small_Polygon> a_pieces, std::span<const Small_Polygon> b_pieces);
+
+// same as above when one side is already convex (bullets, collectibles)
+[[nodiscard]]
+bool concave_sat(Polygon_View convex, Axes_View convex_axes, std::span<const Small_Polygon> pieces);
+
+[[nodiscard]]
+inline
+bool concave_sat(Polygon_View convex, std::span<const Small_Polygon> pieces)
+{ return concave_sat(convex, {}, pieces); }
+
+// Swept SAT for convex polygon 'moving' (given at start position) translated by 'displacement'
+// against static convex polygon 'target'. Projections are swept along each axis,
+// so fast small polygons can't tunnel through target between ticks.
+// Returns time of impact as fraction of displacement in [0, 1], or nothing if they never touch.
+// Axes of either polygon may be precomputed, empty axes are built from edges.
+[[nodiscard]]
+std::optional<float> sweep_sat(Polygon_View moving, Axes_View moving_axes, glm::vec2 displacement,
+                               Polygon_View target, Axes_View target_axes);
+
 [[nodiscard]]
-bool concave_sat(const Polygon& a, const Polygon& b);
+inline
+std::optional<float> sweep_sat(Polygon_View moving, glm::vec2 displacement, Polygon_View target)
+{ return sweep_sat(moving, {}, displacement, target, {}); }
+
+// Earliest time of impact of swept convex polygon against any of convex pieces.
+// On miss 'separating_axis' (if given) is set to axis that alone separates moving polygon
+// from all pieces during whole displacement, or to zero vector if none of tried axes does.
+[[nodiscard]]
+std::optional<float> sweep_concave_sat(Polygon_View moving, Axes_View moving_axes, glm::vec2 displacement,
+                                       std::span<const Small_Polygon> pieces, glm::vec2* separating_axis = nullptr);
+
+[[nodiscard]]
+inline
+std::optional<float> sweep_concave_sat(Polygon_View moving, glm::vec2 displacement, std::span<const Small_Polygon> pieces)
+{ return sweep_concave_sat(moving, {}, displacement, pieces); }
+
+// true if projections of swept 'moving' and of all pieces don't overlap on axis during whole displacement
+[[nodiscard]]
+bool sweep_separates(glm::vec2 axis, Polygon_View moving, glm::vec2 displacement, std::span<const Small_Polygon> pieces);
+
+// where segment enters a shape
+struct Segment_Hit {
+    float fraction; // hit point is from + (to-from)*fraction
+    glm::vec2 normal; // unit, outward normal of entered edge, against segment if it starts inside
+};
+
+// First point of segment from -> to inside convex polygon (either winding), clipped against every edge.
+// Segment starting inside hits at fraction 0.
+[[nodiscard]]
+std::optional<Segment_Hit> segment_cast(Polygon_View convex, glm::vec2 from, glm::vec2 to);
+
+// earliest hit of segment against any of convex pieces
+[[nodiscard]]
+std::optional<Segment_Hit> segment_cast(std::span<const Small_Polygon> pieces, glm::vec2 from, glm::vec2 to);
+
+// same as above, segments missing bounding circle of entity skip the pieces
+[[nodiscard]]
+std::optional<Segment_Hit> segment_cast(const Bounds& bounds, std::span<const Small_Polygon> pieces, glm::vec2 from, glm::vec2 to);
+
+// transforms model space pieces to world space with model matrix of t.
+// storage of world_pieces is reused, so after first call this does not allocate.
+void to_world(const std::vector<Polygon>& model_pieces, const Transform& t, std::vector<Small_Polygon>& world_pieces);
+
+// same as above, and also rotates model space axes by t.angle.
+// inverse of t.scale is folded into axes, so they stay normals for non uniform scale.
+void to_world(const Convex_Model& model, const Transform& t, std::vector<Small_Polygon>& world_pieces);
+
+// same as above for outline that is already in world space (see Vertex_Batch),
+// pieces are gathered from it by their indices, so no vertex is transformed again
+void to_world(const Convex_Model& model, const Transform& t, Polygon_View world_outline, std::vector<Small_Polygon>& world_pieces);
+
+// same as above for storage that already holds one piece per model piece, e.g. pooled by owner
+void to_world(const Convex_Model& model, const Transform& t, Polygon_View world_outline, std::span<Small_Polygon> world_pieces);
+
+// moves world space pieces by offset, e.g. after screen wrap
+void translate(std::span<Small_Polygon> pieces, glm::vec2 offset);
+
+// how far entity with given bounds has to move to come back from other side of world,
+// zero while it still overlaps world
+[[nodiscard]]
+glm::vec2 screen_wrap_offset(const AABB_Collider& aabb, glm::vec2 world_size);
+
+// Runs bounding circle and aabb tests before calling 'polygon_test' (usually concave_sat).
+// Each rejection is recorded in stats, so we can see which stage does the work.
+template <typename Polygon_Test>
+[[nodiscard]]
+bool narrowphase(const Bounds& a, const Bounds& b, Narrowphase_Stats& stats, Polygon_Test&& polygon_test)
+{
+    ++stats.calls;
+    if (!circle_circle(a.center, a.radius, b.center, b.radius)) {
+        ++stats.circle_rejected;
+        return false;
+    }
+    if (!aabb(a.aabb, b.aabb)) {
+        ++stats.aabb_rejected;
+        return false;
+    }
+    if (!polygon_test()) {
+        ++stats.sat_rejected;
+        return false;
+    }
+    return true;
+}
 
 [[nodiscard]]
 float lerp(float a, float b, float alpha);
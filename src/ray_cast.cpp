@@ -0,0 +1,40 @@
+#include "ray_cast.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace peria {
+
+std::size_t wrap_segment(glm::vec2 from, glm::vec2 to, glm::vec2 world_size,
+                         std::array<Segment_Piece, MAX_SEGMENT_PIECES>& out)
+{
+    const auto d = to - from;
+    auto p = from - world_size*glm::floor(from / world_size);
+    auto start = 0.0f;
+
+    std::size_t count{};
+    while (count < out.size()) {
+        // fraction of whole segment where p leaves world on each axis
+        auto exit_fraction = [&](int axis) {
+            if (d[axis] > 0.0f) return (world_size[axis] - p[axis]) / d[axis];
+            if (d[axis] < 0.0f) return -p[axis] / d[axis];
+            return std::numeric_limits<float>::infinity();
+        };
+        const auto exit_x = exit_fraction(0);
+        const auto exit_y = exit_fraction(1);
+        const auto end = std::min(1.0f, start + std::min(exit_x, exit_y));
+
+        const auto piece_to = p + d*(end - start);
+        out[count++] = {p, piece_to, start, end};
+        if (end >= 1.0f) break;
+
+        // continue from opposite edge of every axis that was crossed
+        p = piece_to;
+        if (exit_x <= exit_y) p.x = d.x > 0.0f ? 0.0f : world_size.x;
+        if (exit_y <= exit_x) p.y = d.y > 0.0f ? 0.0f : world_size.y;
+        start = end;
+    }
+    return count;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "aabb_tree.hpp"
+#include "physics.hpp"
+
+namespace peria {
+
+// first entity hit by segment or ray cast
+struct Cast_Hit {
+    uint32_t user; // user value of entity in Aabb_Tree
+    glm::vec2 point; // in world, after wrapping
+    glm::vec2 normal; // unit, outward normal of hit edge
+    float fraction; // of whole segment, across wraps
+};
+
+// part of wrapped segment that lies inside world
+struct Segment_Piece {
+    glm::vec2 from;
+    glm::vec2 to;
+    float start; // fraction of whole segment where piece starts
+    float end;
+};
+
+// longer segments are cut after this many pieces, that is about 4 world sizes
+constexpr std::size_t MAX_SEGMENT_PIECES = 8;
+
+// Cuts segment from -> to into pieces inside world [0, world_size), every piece continues
+// from opposite edge where previous one left world. from is wrapped into world first.
+// Returns number of pieces written to out.
+std::size_t wrap_segment(glm::vec2 from, glm::vec2 to, glm::vec2 world_size,
+                         std::array<Segment_Piece, MAX_SEGMENT_PIECES>& out);
+
+// First entity hit by segment from -> to in world that wraps around at world_size.
+// Tree prunes entities by fat bounds, cast_entity(user, from, to) returns exact 'Segment_Hit'
+// of entity or nullopt, usually 'segment_cast' on its cached convex pieces.
+template <typename Cast_Entity>
+[[nodiscard]]
+std::optional<Cast_Hit> segment_cast_wrapped(const Aabb_Tree& tree, glm::vec2 from, glm::vec2 to, glm::vec2 world_size,
+                                             Cast_Entity&& cast_entity)
+{
+    std::array<Segment_Piece, MAX_SEGMENT_PIECES> pieces;
+    const auto count = wrap_segment(from, to, world_size, pieces);
+    for (std::size_t i{}; i<count; ++i) {
+        const auto& piece = pieces[i];
+
+        // tree keeps last accepted hit, which is also the last one hit test returned
+        glm::vec2 normal{};
+        auto hit_test = [&](uint32_t user, glm::vec2 a, glm::vec2 b) -> std::optional<float> {
+            const std::optional<Segment_Hit> hit = cast_entity(user, a, b);
+            if (!hit) return std::nullopt;
+            normal = hit->normal;
+            return hit->fraction;
+        };
+        const auto hit = tree.ray_cast(piece.from, piece.to, hit_test);
+        if (hit) {
+            return Cast_Hit{hit->user, piece.from + (piece.to - piece.from)*hit->fraction, normal,
+                            piece.start + (piece.end - piece.start)*hit->fraction};
+        }
+    }
+    return std::nullopt;
+}
+
+// ray from origin along unit dir, up to length
+template <typename Cast_Entity>
+[[nodiscard]]
+std::optional<Cast_Hit> ray_cast_wrapped(const Aabb_Tree& tree, glm::vec2 origin, glm::vec2 dir, float length, glm::vec2 world_size,
+                                         Cast_Entity&& cast_entity)
+{ return segment_cast_wrapped(tree, origin, origin + dir*length, world_size, cast_entity); }
+
+}
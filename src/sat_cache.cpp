@@ -0,0 +1,143 @@
+#include "sat_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace peria {
+
+Sat_Cache::Sat_Cache(std::size_t capacity)
+    :_entries(std::bit_ceil(std::max<std::size_t>(capacity, 16)), Entry{EMPTY, {}}),
+     _mask{_entries.size()-1}
+{ _scratch.reserve(_entries.size()); }
+
+std::size_t Sat_Cache::slot_of(uint64_t key) const
+{
+    // splitmix64 finalizer, ids are sequential so they need mixing
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return static_cast<std::size_t>(key) & _mask;
+}
+
+const Sat_Cache::Entry* Sat_Cache::find(uint64_t key) const
+{
+    for (auto i=slot_of(key);; i=(i+1)&_mask) {
+        const auto& e = _entries[i];
+        if (e.key == key) return &e;
+        if (e.key == EMPTY) return nullptr;
+    }
+}
+
+void Sat_Cache::store(uint64_t key, glm::vec2 axis)
+{
+    for (auto i=slot_of(key);; i=(i+1)&_mask) {
+        auto& e = _entries[i];
+        if (e.key == key) {
+            e.axis = axis;
+            return;
+        }
+        if (e.key == EMPTY) {
+            // keep load factor under 3/4 so probes stay short
+            if ((_size+1)*4 > _entries.size()*3) return;
+            e = {key, axis};
+            ++_size;
+            return;
+        }
+    }
+}
+
+void Sat_Cache::erase(uint64_t key)
+{
+    auto i = slot_of(key);
+    for (;; i=(i+1)&_mask) {
+        if (_entries[i].key == key) break;
+        if (_entries[i].key == EMPTY) return;
+    }
+
+    // backward shift deletion, moves following entries of the probe run into the hole
+    for (auto j=(i+1)&_mask; _entries[j].key != EMPTY; j=(j+1)&_mask) {
+        const auto home = slot_of(_entries[j].key);
+        // entry at j can fill the hole if its home slot is not cyclically in (i, j]
+        const auto stays = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) {
+            _entries[i] = _entries[j];
+            i = j;
+        }
+    }
+    _entries[i].key = EMPTY;
+    --_size;
+}
+
+std::optional<float> Sat_Cache::sweep_concave_sat(uint32_t id_a, uint32_t id_b, Polygon_View moving, Axes_View moving_axes,
+                                                  glm::vec2 displacement, std::span<const Small_Polygon> pieces)
+{
+    const auto res = sweep_test(id_a, id_b, moving, moving_axes, displacement, pieces);
+    commit(id_a, id_b, res);
+    return res.toi;
+}
+
+Sat_Cache::Sweep_Result Sat_Cache::sweep_test(uint32_t id_a, uint32_t id_b, Polygon_View moving, Axes_View moving_axes,
+                                              glm::vec2 displacement, std::span<const Small_Polygon> pieces) const
+{
+    auto outcome = Outcome::MISS;
+    if (const auto* e = find(make_key(id_a, id_b))) {
+        if (sweep_separates(e->axis, moving, displacement, pieces)) return {std::nullopt, e->axis, Outcome::HIT};
+        outcome = Outcome::STALE;
+    }
+
+    glm::vec2 axis{};
+    const auto toi = peria::sweep_concave_sat(moving, moving_axes, displacement, pieces, &axis);
+    return {toi, toi ? glm::vec2{0.0f} : axis, outcome};
+}
+
+void Sat_Cache::commit(uint32_t id_a, uint32_t id_b, const Sweep_Result& result)
+{
+    switch (result.outcome) {
+        case Outcome::HIT:
+            // cached axis is still there and unchanged
+            ++_stats.hits;
+            return;
+        case Outcome::STALE:
+            ++_stats.stale;
+            break;
+        case Outcome::MISS:
+            ++_stats.misses;
+            break;
+    }
+
+    const auto key = make_key(id_a, id_b);
+    if (result.axis != glm::vec2{0.0f}) store(key, result.axis);
+    else                                erase(key);
+}
+
+void Sat_Cache::evict(std::span<const uint32_t> dead_ids)
+{
+    if (dead_ids.empty() || _size == 0) return;
+
+    auto is_dead = [&](uint32_t id) {
+        return std::binary_search(dead_ids.begin(), dead_ids.end(), id);
+    };
+
+    // rebuild table from surviving entries, cheaper than erasing one by one
+    _scratch.clear();
+    for (auto& e:_entries) {
+        if (e.key == EMPTY) continue;
+        const auto a = static_cast<uint32_t>(e.key >> 32);
+        const auto b = static_cast<uint32_t>(e.key);
+        if (!is_dead(a) && !is_dead(b)) _scratch.push_back(e);
+        e.key = EMPTY;
+    }
+
+    _size = 0;
+    for (const auto& e:_scratch) store(e.key, e.axis);
+}
+
+void Sat_Cache::clear()
+{
+    std::fill(_entries.begin(), _entries.end(), Entry{EMPTY, {}});
+    _size = 0;
+}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "physics.hpp"
+
+namespace peria {
+
+// how cached axes did during one tick.
+// hits - cached axis still separated the pair, full SAT was skipped.
+// stale - cached axis no longer separates, full SAT was run.
+// misses - pair had no cached axis.
+struct Sat_Cache_Stats {
+    std::size_t hits{};
+    std::size_t stale{};
+    std::size_t misses{};
+};
+
+// Remembers last separating axis of pairs that didn't collide, keyed by stable entity ids
+// (see 'peria::new_entity_id'). Entities move little between ticks, so the same axis
+// usually separates them again and full SAT over all pieces can be skipped.
+// Fixed capacity open addressing table, doesn't allocate after construction.
+// When table is full new pairs are simply not cached.
+class Sat_Cache {
+public:
+    enum class Outcome : uint8_t { HIT, STALE, MISS };
+
+    // result of 'sweep_test', handed back to 'commit'
+    struct Sweep_Result {
+        std::optional<float> toi;
+        glm::vec2 axis; // new separating axis, zero if there is none to cache
+        Outcome outcome;
+    };
+
+    // capacity is rounded up to power of two
+    explicit Sat_Cache(std::size_t capacity = 4096);
+
+    // sweep_concave_sat() that tries cached axis of pair (id_a, id_b) first
+    [[nodiscard]]
+    std::optional<float> sweep_concave_sat(uint32_t id_a, uint32_t id_b, Polygon_View moving, Axes_View moving_axes,
+                                           glm::vec2 displacement, std::span<const Small_Polygon> pieces);
+
+    // Read only half of 'sweep_concave_sat', safe to call from many threads at once
+    // as long as nobody commits or evicts meanwhile.
+    [[nodiscard]]
+    Sweep_Result sweep_test(uint32_t id_a, uint32_t id_b, Polygon_View moving, Axes_View moving_axes,
+                            glm::vec2 displacement, std::span<const Small_Polygon> pieces) const;
+
+    // stores outcome of 'sweep_test' and counts it in stats
+    void commit(uint32_t id_a, uint32_t id_b, const Sweep_Result& result);
+
+    // drops all pairs that contain any of dead ids, dead_ids must be sorted
+    void evict(std::span<const uint32_t> dead_ids);
+
+    void clear();
+
+    // resets stats, call once per tick
+    void reset_stats()
+    { _stats = {}; }
+
+    [[nodiscard]]
+    const Sat_Cache_Stats& stats() const
+    { return _stats; }
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _size; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        glm::vec2 axis;
+    };
+
+    static constexpr uint64_t EMPTY = ~uint64_t{0};
+
+    [[nodiscard]]
+    static uint64_t make_key(uint32_t a, uint32_t b)
+    { return (uint64_t{a} << 32) | b; }
+
+    [[nodiscard]]
+    std::size_t slot_of(uint64_t key) const;
+
+    [[nodiscard]]
+    const Entry* find(uint64_t key) const;
+    void store(uint64_t key, glm::vec2 axis);
+    void erase(uint64_t key);
+
+private:
+    std::vector<Entry> _entries;
+    std::vector<Entry> _scratch; // live entries while rebuilding in 'evict'
+    std::size_t _mask;
+    std::size_t _size{};
+    Sat_Cache_Stats _stats;
+};
+
+}
@@ -0,0 +1,196 @@
+#include "sat_simd.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define PERIA_SAT_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define PERIA_TARGET_AVX2
+    #else
+        #define PERIA_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace peria {
+
+void Soa_Polygon::assign(Polygon_View points)
+{
+    PERIA_ASSERT(points.size() >= 3 && points.size() <= MAX_POINTS, "Soa_Polygon size must be in range [3, MAX_POINTS]");
+
+    count = static_cast<uint32_t>(points.size());
+    padded_count = static_cast<uint32_t>((count+SIMD_WIDTH-1)/SIMD_WIDTH*SIMD_WIDTH);
+    padded_count = std::min<uint32_t>(padded_count, MAX_POINTS);
+
+    for (uint32_t i{}; i<count; ++i) {
+        auto p1 = points[i];
+        auto p2 = points[(i+1)%count];
+
+        // same axis as in 'sat()', so projections match bit for bit
+        auto edge = p2 - p1;
+        xs[i] = p1.x;
+        ys[i] = p1.y;
+        axis_xs[i] = -edge.y;
+        axis_ys[i] = edge.x;
+    }
+
+    // padding repeats last vertex and last axis
+    for (auto i=count; i<padded_count; ++i) {
+        xs[i] = xs[count-1];
+        ys[i] = ys[count-1];
+        axis_xs[i] = axis_xs[count-1];
+        axis_ys[i] = axis_ys[count-1];
+    }
+}
+
+namespace {
+
+#ifndef PERIA_SAT_X86
+// reference kernel for non x86 targets, same math as 'sat()'
+bool sat_soa_scalar(const Soa_Polygon& a, const Soa_Polygon& b)
+{
+    auto project = [](const Soa_Polygon& p, float ax, float ay) -> std::pair<float, float> {
+        auto mn = std::numeric_limits<float>::max();
+        auto mx = std::numeric_limits<float>::lowest();
+        for (uint32_t j{}; j<p.count; ++j) {
+            auto projected = ax*p.xs[j] + ay*p.ys[j];
+            mn = std::min(mn, projected);
+            mx = std::max(mx, projected);
+        }
+        return {mn, mx};
+    };
+
+    for (const auto* axes:{&a, &b}) {
+        for (uint32_t i{}; i<axes->count; ++i) {
+            auto [min_a, max_a] = project(a, axes->axis_xs[i], axes->axis_ys[i]);
+            auto [min_b, max_b] = project(b, axes->axis_xs[i], axes->axis_ys[i]);
+            if ((max_a < min_b) || (max_b < min_a)) return false;
+        }
+    }
+    return true;
+}
+#endif
+
+#ifdef PERIA_SAT_X86
+
+// projects all vertices of p on 4 axes at once
+void project_sse2(const Soa_Polygon& p, __m128 ax, __m128 ay, __m128& mn, __m128& mx)
+{
+    mn = _mm_set1_ps(std::numeric_limits<float>::max());
+    mx = _mm_set1_ps(std::numeric_limits<float>::lowest());
+    for (uint32_t j{}; j<p.count; ++j) {
+        auto projected = _mm_add_ps(_mm_mul_ps(ax, _mm_set1_ps(p.xs[j])),
+                                    _mm_mul_ps(ay, _mm_set1_ps(p.ys[j])));
+        mn = _mm_min_ps(mn, projected);
+        mx = _mm_max_ps(mx, projected);
+    }
+}
+
+// true if projections of a and b overlap on every axis of 'axes'
+bool overlap_on_axes_sse2(const Soa_Polygon& axes, const Soa_Polygon& a, const Soa_Polygon& b)
+{
+    for (uint32_t i{}; i<axes.padded_count; i+=4) {
+        auto ax = _mm_load_ps(&axes.axis_xs[i]);
+        auto ay = _mm_load_ps(&axes.axis_ys[i]);
+
+        __m128 min_a, max_a, min_b, max_b;
+        project_sse2(a, ax, ay, min_a, max_a);
+        project_sse2(b, ax, ay, min_b, max_b);
+
+        auto separated = _mm_or_ps(_mm_cmplt_ps(max_a, min_b), _mm_cmplt_ps(max_b, min_a));
+        if (_mm_movemask_ps(separated) != 0) return false;
+    }
+    return true;
+}
+
+bool sat_soa_sse2(const Soa_Polygon& a, const Soa_Polygon& b)
+{ return overlap_on_axes_sse2(a, a, b) && overlap_on_axes_sse2(b, a, b); }
+
+// projects all vertices of p on 8 axes at once
+PERIA_TARGET_AVX2
+void project_avx2(const Soa_Polygon& p, __m256 ax, __m256 ay, __m256& mn, __m256& mx)
+{
+    mn = _mm256_set1_ps(std::numeric_limits<float>::max());
+    mx = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+    for (uint32_t j{}; j<p.count; ++j) {
+        auto projected = _mm256_add_ps(_mm256_mul_ps(ax, _mm256_set1_ps(p.xs[j])),
+                                       _mm256_mul_ps(ay, _mm256_set1_ps(p.ys[j])));
+        mn = _mm256_min_ps(mn, projected);
+        mx = _mm256_max_ps(mx, projected);
+    }
+}
+
+PERIA_TARGET_AVX2
+bool overlap_on_axes_avx2(const Soa_Polygon& axes, const Soa_Polygon& a, const Soa_Polygon& b)
+{
+    for (uint32_t i{}; i<axes.padded_count; i+=8) {
+        auto ax = _mm256_load_ps(&axes.axis_xs[i]);
+        auto ay = _mm256_load_ps(&axes.axis_ys[i]);
+
+        __m256 min_a, max_a, min_b, max_b;
+        project_avx2(a, ax, ay, min_a, max_a);
+        project_avx2(b, ax, ay, min_b, max_b);
+
+        auto separated = _mm256_or_ps(_mm256_cmp_ps(max_a, min_b, _CMP_LT_OQ),
+                                      _mm256_cmp_ps(max_b, min_a, _CMP_LT_OQ));
+        if (_mm256_movemask_ps(separated) != 0) return false;
+    }
+    return true;
+}
+
+PERIA_TARGET_AVX2
+bool sat_soa_avx2(const Soa_Polygon& a, const Soa_Polygon& b)
+{ return overlap_on_axes_avx2(a, a, b) && overlap_on_axes_avx2(b, a, b); }
+
+bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6); // OSXSAVE + XMM/YMM state
+    if (!os_saves_ymm) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+using Sat_Kernel = bool(*)(const Soa_Polygon&, const Soa_Polygon&);
+
+struct Kernel_Info {
+    Sat_Kernel kernel;
+    const char* name;
+};
+
+// picked once, on first use
+const Kernel_Info& get_kernel()
+{
+    static const Kernel_Info info = []() -> Kernel_Info {
+    #ifdef PERIA_SAT_X86
+        if (cpu_has_avx2()) return {sat_soa_avx2, "avx2"};
+        return {sat_soa_sse2, "sse2"};
+    #else
+        return {sat_soa_scalar, "scalar"};
+    #endif
+    }();
+    return info;
+}
+
+}
+
+bool sat_simd(const Soa_Polygon& a, const Soa_Polygon& b)
+{ return get_kernel().kernel(a, b); }
+
+const char* sat_simd_kernel_name()
+{ return get_kernel().name; }
+
+}
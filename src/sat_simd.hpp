@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+#include "physics.hpp"
+
+namespace peria {
+
+// Experimental, only benchmarks use it (built with PERIA_BENCHMARKS, see "sat_simd" benchmark).
+// Game narrowphase runs scalar sat on pieces with precomputed world space axes (see 'to_world()'),
+// which this layout can't take without SoA copy of every piece per tick.
+
+// Convex polygon stored as structure of arrays for vectorized SAT.
+// Separating axes (edge normals) are precomputed and padded to SIMD_WIDTH
+// by repeating last axis, so kernel can test SIMD_WIDTH axes per instruction.
+// Vertices are padded the same way, repeated vertex does not change projected min/max.
+struct Soa_Polygon {
+    static constexpr std::size_t SIMD_WIDTH = 8; // AVX2 lanes, SSE2 kernel does two halves
+    static constexpr std::size_t MAX_POINTS = 16; // largest asteroid model
+
+    alignas(32) std::array<float, MAX_POINTS> xs{};
+    alignas(32) std::array<float, MAX_POINTS> ys{};
+    alignas(32) std::array<float, MAX_POINTS> axis_xs{};
+    alignas(32) std::array<float, MAX_POINTS> axis_ys{};
+
+    uint32_t count{};        // real vertex count, also real axis count
+    uint32_t padded_count{}; // count rounded up to SIMD_WIDTH
+
+    Soa_Polygon() = default;
+
+    // points are in clockwise order and form convex polygon, same as for 'sat()'
+    explicit Soa_Polygon(Polygon_View points)
+    { assign(points); }
+
+    void assign(Polygon_View points);
+};
+
+// Same result as 'sat(const Polygon&, const Polygon&)', but projects both polygons
+// on several axes at once. Uses AVX2 if cpu supports it, otherwise SSE2 (scalar on non x86).
+[[nodiscard]]
+bool sat_simd(const Soa_Polygon& a, const Soa_Polygon& b);
+
+// name of kernel picked at runtime, for logging
+[[nodiscard]]
+const char* sat_simd_kernel_name();
+
+}
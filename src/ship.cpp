@@ -4,6 +4,7 @@
 #include "input_manager.hpp"
 #include "physics.hpp"
 #include "game.hpp"
+#include "vertex_batch.hpp"
 
 #include <algorithm>
 
@@ -23,6 +24,13 @@ init_ship_model()
     }};
 }
 
+// ship model is concave, so split it once and only transform pieces and axes per tick
+const peria::Convex_Model& Ship::get_convex_model()
+{
+    static const auto model = peria::make_convex_model(init_ship_model());
+    return model;
+}
+
 Ship::Ship(glm::vec2 world_pos)
     :_ship_model{init_ship_model()}, _initial_pos{world_pos},
      _transform{world_pos, {25.0f, 20.0f}, 0.0f},
@@ -30,6 +38,12 @@ Ship::Ship(glm::vec2 world_pos)
      _invincible{false}
 {
     first_move = false;
+
+    // scale does not change, so radius is computed once
+    for (const auto& p:_ship_model) {
+        _bounds.radius = std::max(_bounds.radius, glm::length(p*_transform.scale));
+    }
+    update_collider();
 }
 
 void Ship::restart()
@@ -41,6 +55,7 @@ void Ship::restart()
     _invincible = false;
     _accum = 0.0f;
     first_move = false;
+    update_collider();
 }
 
 void Ship::update(Input_Manager& im, float dt)
@@ -72,37 +87,32 @@ void Ship::update(Input_Manager& im, float dt)
         }
     }
 
-    // screen wrap
-    auto world_pos = get_points_in_world();
-    auto min_x = std::min_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.x<b.x;})->x;
-    auto max_x = std::max_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.x<b.x;})->x;
-    auto min_y = std::min_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.y<b.y;})->y;
-    auto max_y = std::max_element(world_pos.begin(), world_pos.end(), [](glm::vec2 a, glm::vec2 b) {return a.y<b.y;})->y;
-    
-    const auto [w, h] = Game::get_world_size();
-
-    bool wrap = false;
-    if (min_x > w) {
-        _transform.pos.x -= (w+max_x-min_x);
-        wrap = true;
-    }
-    else if (max_x < 0.0f) {
-        _transform.pos.x += (w+max_x-min_x);
-        wrap = true;
-    }
+    if (_invincible) iframes(dt);
+}
 
-    if (min_y > h) {
-        _transform.pos.y -= (h+max_y-min_y);
-        wrap = true;
-    }
-    else if (max_y < 0.0f) {
-        _transform.pos.y += (h+max_y-min_y);
-        wrap = true;
-    }
+void Ship::update_collider()
+{
+    std::array<glm::vec2, peria::Small_Polygon::CAPACITY> world_outline;
+    peria::transform_points(peria::Affine_2d::from(_transform), _ship_model, world_outline);
+    update_collider(std::span{world_outline}.first(_ship_model.size()));
+}
 
-    if (wrap) _prev_transform = _transform;
+void Ship::update_collider(std::span<const glm::vec2> world_outline)
+{
+    peria::to_world(get_convex_model(), _transform, world_outline, _world_pieces);
+    _bounds.center = _transform.pos;
+    _bounds.aabb = peria::aabb_of(_world_pieces);
 
-    if (_invincible) iframes(dt);
+    // screen wrap only moves ship, so collider is moved along instead of rebuilt
+    const auto [w, h] = Game::get_world_size();
+    const auto offset = peria::screen_wrap_offset(_bounds.aabb, {w, h});
+    if (offset != glm::vec2{0.0f}) {
+        _transform.pos += offset;
+        _prev_transform = _transform;
+        peria::translate(_world_pieces, offset);
+        _bounds.center += offset;
+        _bounds.aabb.pos += offset;
+    }
 }
 
 void Ship::iframes(float step)
@@ -142,42 +152,26 @@ void Ship::upgrade_speed()
 void Ship::upgrade_rotation_speed()
 { _rot_speed += 35.0f; }
 
-void Ship::draw(Graphics& g, float alpha) const
+void Ship::draw(Graphics& g, std::span<const glm::vec2> world_outline) const
 { 
-    auto t = peria::interpolate_state(_prev_transform, _transform, alpha);
     if (_invincible) {
-        g.draw_polygon(get_points_in_world_interpolated(t), {0.863f, 0.078f, 0.235f, 0.7f}); 
+        g.draw_polygon(world_outline, {0.863f, 0.078f, 0.235f, 0.7f}); 
     }
     else {
-        g.draw_polygon(get_points_in_world_interpolated(t), {0.55f, 0.3f, 0.8f, 1.0f}); 
+        g.draw_polygon(world_outline, {0.55f, 0.3f, 0.8f, 1.0f}); 
     }
 }
 
-// returns world positions for polygon points
-// for physics.
-std::vector<glm::vec2> Ship::get_points_in_world() const
+Transform Ship::get_interpolated_transform(float alpha) const
 {
-    std::vector<glm::vec2> vec; vec.reserve(_ship_model.size());
-    auto transform = Transform::model(_transform.pos, _transform.scale, _transform.angle);
-    for (const auto& p:_ship_model) {
-        glm::vec4 v{p.x, p.y, 0.0f, 1.0f};
-        glm::vec4 transformed = transform*v;
-        vec.emplace_back(transformed.x, transformed.y);
-    }
-    return vec;
+    // angle is not interpolated, it jumps at 360
+    auto t = peria::interpolate_state(_prev_transform, _transform, alpha);
+    t.angle = _transform.angle;
+    return t;
 }
 
-std::vector<glm::vec2> Ship::get_points_in_world_interpolated(const Transform& interpolated_transform) const
-{
-    std::vector<glm::vec2> vec; vec.reserve(_ship_model.size());
-    auto model = Transform::model(interpolated_transform.pos, interpolated_transform.scale, _transform.angle);
-    for (const auto& p:_ship_model) {
-        glm::vec4 v{p.x, p.y, 0.0f, 1.0f};
-        glm::vec4 transformed = model*v;
-        vec.emplace_back(transformed.x, transformed.y);
-    }
-    return vec;
-}
+glm::vec2 Ship::get_tip_in_world() const
+{ return peria::Affine_2d::from(_transform).apply(_ship_model[2]); }
 
 glm::vec2 Ship::get_direction_vector() const
 { return {std::cos(glm::radians(_transform.angle+90.0f)), std::sin(glm::radians(_transform.angle+90.0f))}; }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <span>
 #include <vector>
 #include "transform.hpp"
+#include "physics.hpp"
 
 class Input_Manager;
 class Graphics;
@@ -9,14 +11,47 @@ class Graphics;
 class Ship {
 public:
     Ship(glm::vec2 world_pos);
+
+    // moves ship, collider follows in 'update_collider'
     void update(Input_Manager& im, float dt);
-    void draw(Graphics& g, float alpha) const;
 
+    // world_outline is model moved by interpolated transform (see Vertex_Batch)
+    void draw(Graphics& g, std::span<const glm::vec2> world_outline) const;
+
+    // Rebuilds convex pieces and bounds from model outline moved to world space by current
+    // transform (see Vertex_Batch), then wraps ship around world edges. Once per tick after 'update'.
+    void update_collider(std::span<const glm::vec2> world_outline);
+
+    // polygon in model space
+    [[nodiscard]]
+    const std::vector<glm::vec2>& get_model() const
+    { return _ship_model; }
+
+    [[nodiscard]]
+    const Transform& get_transform() const
+    { return _transform; }
+
+    // transform between previous and current tick, for drawing
     [[nodiscard]]
-    std::vector<glm::vec2> get_points_in_world() const;
+    Transform get_interpolated_transform(float alpha) const;
 
+    // convex pieces of ship model with their axes, in model space
     [[nodiscard]]
-    std::vector<glm::vec2> get_points_in_world_interpolated(const Transform& interpolated_transform) const;
+    static const peria::Convex_Model& get_convex_model();
+
+    // convex pieces of ship polygon in world space, updated once per tick
+    [[nodiscard]]
+    const std::vector<peria::Small_Polygon>& get_convex_pieces_in_world() const
+    { return _world_pieces; }
+
+    // bounding circle and aabb in world space, updated once per tick
+    [[nodiscard]]
+    const peria::Bounds& get_bounds() const
+    { return _bounds; }
+
+    // tip of the ship in world space, bullets spawn here
+    [[nodiscard]]
+    glm::vec2 get_tip_in_world() const;
 
     [[nodiscard]]
     glm::vec2 get_direction_vector() const;
@@ -39,8 +74,14 @@ public:
     void upgrade_max_health();
     void upgrade_speed();
     void upgrade_rotation_speed();
+private:
+    // same as public overload, transforms outline itself. used on spawn and restart
+    void update_collider();
+
 private:
     std::vector<glm::vec2> _ship_model;
+    std::vector<peria::Small_Polygon> _world_pieces;
+    peria::Bounds _bounds{};
 
     glm::vec2 _initial_pos;
     Transform _transform{};
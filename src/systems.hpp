@@ -0,0 +1,111 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#include "components.hpp"
+#include "ecs.hpp"
+#include "physics.hpp"
+
+namespace peria {
+
+// Systems shared by every entity type in World, see ecs.hpp.
+// Per entity ones are safe to run with World::run(jobs, ...).
+
+// stores previous transform and moves entity by its velocity
+struct Integrate {
+    using Query = peria::Query<Transform, Prev_Transform, Velocity>;
+    float dt;
+
+    void operator()(Transform& t, Prev_Transform& prev, const Velocity& v) const
+    {
+        static_cast<Transform&>(prev) = t;
+        t.pos += v.linear*dt;
+        t.angle += v.angular*dt;
+        Transform::clamp_angle(t.angle);
+    }
+};
+
+// Entity that fully left world appears at opposite edge, it is treated as circle of radius scale.x/2.
+// Previous transform follows, so swept tests don't see a jump across world.
+struct Wrap_Around {
+    using Query = peria::Query<Transform, Prev_Transform>;
+    glm::vec2 world_size;
+
+    void operator()(Transform& t, Prev_Transform& prev) const
+    {
+        auto& pos = t.pos;
+        const auto radius = t.scale.x*0.5f;
+        bool wrap = false;
+        if (pos.x-radius > world_size.x) {
+            pos.x -= world_size.x+radius;
+            wrap = true;
+        }
+        if (pos.x+radius < 0.0f) {
+            pos.x += world_size.x+radius;
+            wrap = true;
+        }
+        if (pos.y-radius > world_size.y) {
+            pos.y -= world_size.y+radius;
+            wrap = true;
+        }
+        if (pos.y+radius < 0.0f) {
+            pos.y += world_size.y+radius;
+            wrap = true;
+        }
+        if (wrap) static_cast<Transform&>(prev) = t;
+    }
+};
+
+// bounds of square path travelled during tick, square side is scale.x
+struct Swept_Bounds {
+    using Query = peria::Query<Transform, Prev_Transform, Collider>;
+
+    void operator()(const Transform& t, const Prev_Transform& prev, Collider& c) const
+    { c.bounds = swept_square_bounds(prev.pos, t.pos, t.scale.x*0.5f); }
+};
+
+// Removes entities with no hp left, their colliders leave tree and ids are appended to dead_ids.
+// Rows of other entities change, see Archetype::remove.
+template <typename World>
+void remove_dead(World& world, Aabb_Tree& tree, std::pmr::vector<uint32_t>& dead_ids)
+{
+    world.template each_archetype<Health>([&](auto& a) {
+        const auto health = a.template get<Health>();
+        std::size_t i{};
+        while (i < a.size()) {
+            if (health[i].hp > 0) {
+                ++i;
+                continue;
+            }
+            if constexpr (std::remove_reference_t<decltype(a)>::template has<Collider>) {
+                const auto proxy = a.template get<Collider>()[i].proxy;
+                if (proxy != Aabb_Tree::NONE) tree.remove(proxy);
+            }
+            dead_ids.push_back(a.ids()[i]);
+            a.remove(i);
+        }
+    });
+}
+
+// draws every renderable entity, moving ones between previous and current tick
+template <typename World, typename Renderer>
+void draw_rects(World& world, Renderer& g, float alpha)
+{
+    world.template each_archetype<Transform, Renderable>([&](auto& a) {
+        const auto transforms = a.template get<Transform>();
+        const auto renderables = a.template get<Renderable>();
+        for (std::size_t i{}; i<a.size(); ++i) {
+            auto t = transforms[i];
+            if constexpr (std::remove_reference_t<decltype(a)>::template has<Prev_Transform>) {
+                t = interpolate_state(a.template get<Prev_Transform>()[i], t, alpha);
+            }
+            g.draw_rect({t.pos.x-t.scale.x*0.5f, t.pos.y+t.scale.y*0.5f}, t.scale, renderables[i].color);
+        }
+    });
+}
+
+}
@@ -0,0 +1,66 @@
+#include "vertex_batch.hpp"
+
+#include <cmath>
+
+#include "opengl_errors.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define PERIA_BATCH_X86
+    #include <emmintrin.h>
+#endif
+
+namespace peria {
+
+Affine_2d Affine_2d::from(const Transform& t)
+{
+    const auto angle = glm::radians(t.angle);
+    const auto c = std::cos(angle);
+    const auto s = std::sin(angle);
+    return {c*t.scale.x, -s*t.scale.y, s*t.scale.x, c*t.scale.y, t.pos};
+}
+
+void transform_points(const Affine_2d& affine, std::span<const glm::vec2> in, std::span<glm::vec2> out)
+{
+    PERIA_ASSERT(out.size() >= in.size(), "transform_points output is too small");
+    std::size_t i{};
+
+#ifdef PERIA_BATCH_X86
+    // two interleaved points (x0 y0 x1 y1) per register,
+    // columns of matrix are repeated to match: x*(m00 m10 m00 m10) + y*(m01 m11 m01 m11)
+    const auto col_x = _mm_setr_ps(affine.m00, affine.m10, affine.m00, affine.m10);
+    const auto col_y = _mm_setr_ps(affine.m01, affine.m11, affine.m01, affine.m11);
+    const auto translation = _mm_setr_ps(affine.translation.x, affine.translation.y, affine.translation.x, affine.translation.y);
+    for (; i+2<=in.size(); i+=2) {
+        const auto p = _mm_loadu_ps(&in[i].x);
+        const auto xs = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+        const auto ys = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+        _mm_storeu_ps(&out[i].x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, col_x), _mm_mul_ps(ys, col_y)), translation));
+    }
+#endif
+
+    for (; i<in.size(); ++i) {
+        out[i] = affine.apply(in[i]);
+    }
+}
+
+void Vertex_Batch::clear()
+{
+    _entries.clear();
+    _vertices.clear();
+}
+
+std::size_t Vertex_Batch::add(std::span<const glm::vec2> model, const Transform& t)
+{
+    _entries.push_back({model, Affine_2d::from(t), static_cast<uint32_t>(_vertices.size())});
+    _vertices.resize(_vertices.size() + model.size());
+    return _entries.size()-1;
+}
+
+void Vertex_Batch::expand()
+{
+    for (const auto& e:_entries) {
+        transform_points(e.affine, e.model, std::span{_vertices}.subspan(e.begin, e.model.size()));
+    }
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "transform.hpp"
+
+namespace peria {
+
+// 2D part of Transform::model(), rotation times scale plus translation.
+// Maps p to (m00*x + m01*y, m10*x + m11*y) + translation.
+struct Affine_2d {
+    float m00;
+    float m01;
+    float m10;
+    float m11;
+    glm::vec2 translation;
+
+    [[nodiscard]]
+    static Affine_2d from(const Transform& t);
+
+    [[nodiscard]]
+    glm::vec2 apply(glm::vec2 p) const
+    { return {m00*p.x + m01*p.y + translation.x, m10*p.x + m11*p.y + translation.y}; }
+};
+
+// Writes affine applied to every point of in to out, which must be at least as big.
+// SSE2 does two points per instruction, scalar on non x86.
+void transform_points(const Affine_2d& affine, std::span<const glm::vec2> in, std::span<glm::vec2> out);
+
+// World space outlines of many entities in one contiguous buffer.
+// Entities are added with their model and transform, then 'expand' transforms all of them
+// in one pass. Game fills one batch per tick for colliders and one per frame for drawing,
+// with interpolated transforms. Doesn't allocate once buffers have grown.
+class Vertex_Batch {
+public:
+    void clear();
+
+    // model must stay alive until 'expand', returns index of entry for 'vertices'
+    std::size_t add(std::span<const glm::vec2> model, const Transform& t);
+
+    void expand();
+
+    // world space vertices of entry, valid after 'expand'
+    [[nodiscard]]
+    std::span<const glm::vec2> vertices(std::size_t entry) const
+    { return {_vertices.data() + _entries[entry].begin, _entries[entry].model.size()}; }
+
+    [[nodiscard]]
+    std::span<const glm::vec2> vertices() const
+    { return _vertices; }
+
+    [[nodiscard]]
+    std::size_t size() const
+    { return _entries.size(); }
+
+private:
+    struct Entry {
+        std::span<const glm::vec2> model;
+        Affine_2d affine;
+        uint32_t begin; // first vertex in _vertices
+    };
+
+    std::vector<Entry> _entries;
+    std::vector<glm::vec2> _vertices;
+};
+
+}
@@ -3,6 +3,8 @@
 #include <cmath>
 #include <glm/trigonometric.hpp>
 
+#include "graphics.hpp"
+
 // Delay - number of seconds per shots
 // Timer - how many seconds a weapong can be used
 
@@ -16,9 +18,9 @@ void Gun::reset()
 
 // default gun shoots 1 bullet at a time from tip of the ship with relatively small delay.
 void Gun::shoot(const glm::vec2& pos, const glm::vec2& dir,
-                std::vector<Bullet>& bullets) 
+                Bullet_Pool& bullets) 
 { 
-    bullets.emplace_back(pos, 4.5f, dir, _bullet_color); 
+    bullets.spawn(pos, dir, Bullet_Type::GUN); 
     _delay = Gun::_initial_delay;
 }
 
@@ -40,7 +42,7 @@ void Shotgun::update(float dt)
 
 // shotgun shoots several bullets in cone shape from tip of ship with relatively large delay
 void Shotgun::shoot(const glm::vec2& pos, const glm::vec2& dir,
-                    std::vector<Bullet>& bullets)
+                    Bullet_Pool& bullets)
 { 
     auto angle1 = glm::radians(10.0f);
     auto angle2 = glm::radians(-10.0f);
@@ -54,21 +56,21 @@ void Shotgun::shoot(const glm::vec2& pos, const glm::vec2& dir,
         std::sin(angle2)*dir.x + std::cos(angle2)*dir.y,
     };
 
-    bullets.push_back(Bullet(pos, 5.0f, dir, _bullet_color));
-    bullets.push_back(Bullet(pos + dir_left*15.0f, 5.0f, dir_left, _bullet_color));
-    bullets.push_back(Bullet(pos + dir_right*15.0f, 5.0f, dir_right, _bullet_color));
+    bullets.spawn(pos, dir, Bullet_Type::SHOTGUN);
+    bullets.spawn(pos + dir_left*15.0f, dir_left, Bullet_Type::SHOTGUN);
+    bullets.spawn(pos + dir_right*15.0f, dir_right, Bullet_Type::SHOTGUN);
     
     if (_upgrade_level >= 1) {
-        bullets.push_back(Bullet(pos + dir_right*30.0f, 5.0f, dir_right, _bullet_color));
-        bullets.push_back(Bullet(pos + dir_left*30.0f, 5.0f, dir_left, _bullet_color));
+        bullets.spawn(pos + dir_right*30.0f, dir_right, Bullet_Type::SHOTGUN);
+        bullets.spawn(pos + dir_left*30.0f, dir_left, Bullet_Type::SHOTGUN);
     }
     if (_upgrade_level >= 2) {
-        bullets.push_back(Bullet(pos + dir*30.0f, 5.0f, dir, _bullet_color));
-        bullets.push_back(Bullet(pos + dir*15.0f, 5.0f, dir, _bullet_color));
+        bullets.spawn(pos + dir*30.0f, dir, Bullet_Type::SHOTGUN);
+        bullets.spawn(pos + dir*15.0f, dir, Bullet_Type::SHOTGUN);
     }
     if (_upgrade_level >= 3) {
-        bullets.push_back(Bullet(pos + dir_right*45.0f, 5.0f, dir_right, _bullet_color));
-        bullets.push_back(Bullet(pos + dir_left*45.0f, 5.0f, dir_left, _bullet_color));
+        bullets.spawn(pos + dir_right*45.0f, dir_right, Bullet_Type::SHOTGUN);
+        bullets.spawn(pos + dir_left*45.0f, dir_left, Bullet_Type::SHOTGUN);
     }
 
     _delay = Shotgun::_initial_delay;
@@ -94,25 +96,6 @@ float Shotgun::timer() const
 // START HOMING_ROCKET =================================================================
 // =====================================================================================
 
-int Homing_Gun::search(glm::vec2 ship_pos, const std::vector<Asteroid>& asteroids) 
-{
-    int index_to_target = -1;
-    float current_min = std::numeric_limits<float>::max();
-    auto asteroids_len = static_cast<int>(asteroids.size());
-    for (int i{}; i<asteroids_len; ++i) {
-        const auto& a = asteroids[i];
-        auto a_pos = a.get_world_pos();
-
-        auto distance_squared = (a_pos.x-ship_pos.x)*(a_pos.x-ship_pos.x) + (a_pos.y-ship_pos.y)*(a_pos.y-ship_pos.y); 
-        if (distance_squared < current_min) {
-            index_to_target = i;
-            current_min = distance_squared;
-        }
-    }
-
-    return index_to_target;
-}
-
 void Homing_Gun::update(float dt)
 {
     _delay -= dt;
@@ -136,5 +119,14 @@ float Homing_Gun::delay() const
 
 float Homing_Gun::timer() const
 { return _timer; }
+
+void Homing_Gun::draw_radar(Graphics& g, glm::vec2 pos) const
+{
+    for (std::size_t i{}; i<_radar_count; ++i) {
+        const auto target = pos + _radar_offsets[i];
+        g.draw_line(pos, target, {1.0f, 0.5f, 1.0f, 0.35f});
+        g.draw_circle(target, 4.0f, {1.0f, 0.5f, 1.0f, 0.8f});
+    }
+}
 // END HOMING_ROCKET ===================================================================
 // =====================================================================================
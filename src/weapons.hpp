@@ -1,5 +1,10 @@
 #pragma once
 
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <array>
+#include <limits>
+
 #include "asteroid.hpp"
 #include "bullet.hpp"
 
@@ -7,7 +12,7 @@ class Gun {
 public:
     void update(float dt);
     void shoot(const glm::vec2& pos, const glm::vec2& dir,
-               std::vector<Bullet>& bullets);
+               Bullet_Pool& bullets);
     void reset();
 
     [[nodiscard]]
@@ -16,7 +21,6 @@ public:
     void set_initial_delay(const float delay);
 private:
     float _delay{};
-    glm::vec4 _bullet_color{0.5f, 0.6f, 0.7f, 1.0f};
 
     float _initial_delay{0.35f};
 };
@@ -25,7 +29,7 @@ class Shotgun {
 public:
     void update(float dt);
     void shoot(const glm::vec2& pos, const glm::vec2& dir,
-               std::vector<Bullet>& bullets);
+               Bullet_Pool& bullets);
     void reset();
 
     void upgrade();
@@ -40,22 +44,34 @@ private:
     float _timer{10.0f};
     uint8_t _upgrade_level{0};
 
-    glm::vec4 _bullet_color{0.8f, 0.6f, 0.7f, 1.0f};
-
     static constexpr float _initial_delay{1.0f};
     static constexpr float _initial_timer{10.0f};
 };
 
 class Homing_Gun {
 public:
+    // how many asteroids radar keeps locked
+    static constexpr std::size_t RADAR_TARGETS = 4;
+
+    // Asteroid to lock on, -1 if there are none. Nearest asteroid inside cone in front of ship,
+    // nearest one anywhere if cone is empty. Queries collider tree, distances wrap around world edges.
+    // to_asteroid(user) maps tree user value to asteroid index, -1 for other colliders.
+    template <typename To_Asteroid>
     [[nodiscard]]
-    int search(glm::vec2 ship_pos, const std::vector<Asteroid>& asteroids);
+    int search(glm::vec2 ship_pos, glm::vec2 ship_dir, const Asteroid_Pool& asteroids,
+               const peria::Aabb_Tree& tree, glm::vec2 world_size, To_Asteroid&& to_asteroid) const;
+
+    // locks RADAR_TARGETS nearest asteroids for 'draw_radar', cheap enough to run every tick
+    template <typename To_Asteroid>
+    void update_radar(glm::vec2 ship_pos, const Asteroid_Pool& asteroids,
+                      const peria::Aabb_Tree& tree, glm::vec2 world_size, To_Asteroid&& to_asteroid);
 
     void update(float dt);
     void reset();
     void do_delay();
 
-    void draw_radar(Graphics& g, glm::vec2 pos);
+    // line from pos to every locked asteroid, the short way around world edges
+    void draw_radar(Graphics& g, glm::vec2 pos) const;
 
     void set_delay(float d);
     [[nodiscard]]
@@ -69,4 +85,52 @@ private:
 
     float _initial_delay{1.5f};
     static constexpr float _initial_timer{10.0f};
+
+    // cos of half angle of search cone, 30 degrees to each side of ship direction
+    static constexpr float _cone_cos{0.866f};
+
+    std::vector<peria::Aabb_Tree::Nearest_Hit> _radar_hits; // reused query buffer
+    std::array<glm::vec2, RADAR_TARGETS> _radar_offsets{}; // ship to locked asteroid
+    std::size_t _radar_count{};
 };
+
+template <typename To_Asteroid>
+int Homing_Gun::search(glm::vec2 ship_pos, glm::vec2 ship_dir, const Asteroid_Pool& asteroids,
+                       const peria::Aabb_Tree& tree, glm::vec2 world_size, To_Asteroid&& to_asteroid) const
+{
+    constexpr auto SKIP = std::numeric_limits<float>::infinity();
+    auto distance_in_cone = [&](uint32_t user, glm::vec2 from) {
+        const int index = to_asteroid(user);
+        if (index < 0) return SKIP;
+        const auto d = asteroids[index].get_world_pos() - from;
+        const auto len = glm::length(d);
+        return glm::dot(d, ship_dir) >= len*_cone_cos ? len : SKIP;
+    };
+    auto distance_any = [&](uint32_t user, glm::vec2 from) {
+        const int index = to_asteroid(user);
+        return index < 0 ? SKIP : glm::length(asteroids[index].get_world_pos() - from);
+    };
+
+    auto hit = tree.nearest_in_cone_wrapped(ship_pos, {ship_dir, _cone_cos}, world_size, distance_in_cone);
+    if (!hit) hit = tree.nearest_wrapped(ship_pos, world_size, distance_any);
+    return hit ? to_asteroid(hit->user) : -1;
+}
+
+template <typename To_Asteroid>
+void Homing_Gun::update_radar(glm::vec2 ship_pos, const Asteroid_Pool& asteroids,
+                              const peria::Aabb_Tree& tree, glm::vec2 world_size, To_Asteroid&& to_asteroid)
+{
+    auto distance = [&](uint32_t user, glm::vec2 from) {
+        const int index = to_asteroid(user);
+        return index < 0 ? std::numeric_limits<float>::infinity() : glm::length(asteroids[index].get_world_pos() - from);
+    };
+    tree.k_nearest_wrapped(ship_pos, world_size, RADAR_TARGETS, distance, _radar_hits);
+
+    // hits don't say which shifted point found them, so shortest offset is recomputed
+    _radar_count = _radar_hits.size();
+    for (std::size_t i{}; i<_radar_count; ++i) {
+        auto d = asteroids[to_asteroid(_radar_hits[i].user)].get_world_pos() - ship_pos;
+        d -= world_size * glm::round(d / world_size);
+        _radar_offsets[i] = d;
+    }
+}